@@ -21,16 +21,19 @@ verts = glob.glob(os.path.join(target_directory, 'HLSL_DX12/*.vert'), recursive=
 frags = glob.glob(os.path.join(target_directory, 'HLSL_DX12/*.frag'), recursive=True)
 comps = glob.glob(os.path.join(target_directory, 'HLSL_DX12/*.comp'), recursive=True)
 
-for target,directory in [
-    ('-M', 'Metal'),
-    ('-V', 'GLSL_VULKAN'),
-    ('-G', 'GLSL_GL')]:
-    for kind,paths in [
-        ('--vert', verts),
-        ('--frag', frags),
-        ('--comp', comps) ]:
-        for f in paths:
-            subprocess.call(['ShaderTranspiler', kind, target, '--input', f, '--output', os.path.join(target_directory, directory, os.path.basename(f))])
+# SPIR-V is generated once for all targets of each shader
+for kind,paths in [
+    ('--vert', verts),
+    ('--frag', frags),
+    ('--comp', comps) ]:
+    for f in paths:
+        outputs = []
+        for option,directory in [
+            ('--output-msl', 'Metal'),
+            ('--output-vulkan-glsl', 'GLSL_VULKAN'),
+            ('--output-glsl', 'GLSL_GL')]:
+            outputs += [option, os.path.join(target_directory, directory, os.path.basename(f))]
+        subprocess.call(['ShaderTranspiler', kind, '--parallel', '--input', f] + outputs)
 
 verts = glob.glob(os.path.join(target_directory, 'GLSL_VULKAN/*.vert'), recursive=True)
 frags = glob.glob(os.path.join(target_directory, 'GLSL_VULKAN/*.frag'), recursive=True)
@@ -38,3 +41,15 @@ comps = glob.glob(os.path.join(target_directory, 'GLSL_VULKAN/*.comp'), recursiv
 
 for f in (verts + frags + comps):
     subprocess.call(['glslangValidator', f, '-e', 'main', '-V', '-o', os.path.join(target_directory, 'SPIRV', os.path.basename(f)) + '.spv'])
+
+# all stages and targets are packed into a bundle which is loaded with LLGI::ShaderBundle
+bundle_list_path = os.path.join(target_directory, 'shaders.bundle.txt')
+with open(bundle_list_path, 'w') as bundle_list:
+    for directory in ['HLSL_DX12', 'Metal', 'GLSL_VULKAN', 'GLSL_GL', 'SPIRV']:
+        for f in sorted(glob.glob(os.path.join(target_directory, directory, '*'))):
+            name = f[:-len('.spv')] if f.endswith('.spv') else f
+            if os.path.splitext(name)[1] in ['.vert', '.frag', '.comp']:
+                bundle_list.write(directory + ' ' + f + '\n')
+
+subprocess.call(['ShaderTranspiler', '--bundle', os.path.join(target_directory, 'shaders.bundle'), bundle_list_path])
+os.remove(bundle_list_path)
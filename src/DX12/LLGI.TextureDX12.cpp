@@ -67,6 +67,7 @@ bool TextureDX12::Initialize(const TextureParameter& parameter)
 	textureSize_ = parameter.Size;
 	samplingCount_ = parameter.SampleCount;
 	parameter_ = parameter;
+	usage_ = parameter.Usage;
 
 	type_ = TextureType::Color;
 
@@ -274,6 +274,11 @@ enum class TextureUsageType : uint32_t
 	RenderTarget = 1 << 0,
 	Array = 1 << 1,
 	External = 1 << 2,
+
+	/**
+		@brief	an attachment which is used only in a render pass. It can't be sampled, copied or read after the render pass.
+	*/
+	Transient = 1 << 3,
 };
 
 inline TextureUsageType operator|(TextureUsageType lhs, TextureUsageType rhs)
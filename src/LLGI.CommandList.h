@@ -12,6 +12,44 @@ static constexpr int NumComputeBuffer = TextureSlotMax;
 class VertexBuffer;
 class IndexBuffer;
 
+/**
+	@brief	a result of a copy from GPU to CPU which is recorded into a command list
+	@note
+	The data can be read after the command list is executed and completed on GPU.
+	It doesn't need to wait the whole device, so tokens of several frames can be in flight.
+*/
+class ReadbackToken : public ReferenceObject
+{
+public:
+	ReadbackToken() = default;
+	~ReadbackToken() override = default;
+
+	/**
+		@brief	whether the copy is completed. It doesn't block.
+	*/
+	virtual bool IsReady() { return false; }
+
+	/**
+		@brief	wait until the copy is completed. It fails if the command list has not been executed.
+	*/
+	virtual bool Wait() { return false; }
+
+	/**
+		@brief	get the copied data. It returns nullptr until the copy is completed.
+	*/
+	virtual const void* GetData() { return nullptr; }
+
+	/**
+		@brief	get the size of the copied data in bytes
+	*/
+	virtual int32_t GetSize() const { return 0; }
+
+	/**
+		@brief	get the size of a row in bytes when it is copied from a texture
+	*/
+	virtual int32_t GetRowPitch() const { return 0; }
+};
+
 /**
 	@brief	command list
 	@note
@@ -172,6 +210,30 @@ public:
 
 	virtual void CopyBuffer(Buffer* src, Buffer* dst) {}
 
+	/**
+		@brief	make commands in this command list wait until commands in the specified command list are finished on GPU
+		@note
+		It is called between Begin and End. The specified command list must be executed before this command list.
+		It is required when command lists are executed on different queues, for example, a command list created by
+		Graphics::CreateComputeCommandList. On a single queue, commands are already executed in the executed order.
+	*/
+	virtual void WaitCommandList(CommandList* commandList) {}
+
+	/**
+		@brief	record a copy of a region of a texture into memory which CPU can read
+		@note
+		It must be called outside of RenderPass. Rows of the copied data are packed tightly.
+		The returned token must be released by a caller.
+	*/
+	virtual ReadbackToken* ReadbackTexture(Texture* src, const Vec2I& position, const Vec2I& size) { return nullptr; }
+
+	/**
+		@brief	record a copy of a range of a buffer into memory which CPU can read
+		@note
+		The buffer must be created with BufferUsageType::CopySrc. The returned token must be released by a caller.
+	*/
+	virtual ReadbackToken* ReadbackBuffer(Buffer* src, int32_t offset, int32_t size) { return nullptr; }
+
 	/**
 		@brief	send a memory in specified texture from cpu to gpu
 	*/
@@ -7,4 +7,17 @@ void Compiler::Initialize() {}
 
 void Compiler::Compile(CompilerResult& result, const char* code, ShaderStageType shaderStage) {}
 
+void Compiler::CompileBatch(std::vector<CompilerResult>& results, const std::vector<CompilerInput>& inputs)
+{
+	results.clear();
+	results.resize(inputs.size());
+
+	for (size_t i = 0; i < inputs.size(); i++)
+	{
+		Compile(results[i], inputs[i].Code, inputs[i].ShaderStage);
+	}
+}
+
+void Compiler::SetCacheDirectory(const char* directory) {}
+
 } // namespace LLGI
@@ -13,6 +13,12 @@ struct CompilerResult
 	std::vector<std::vector<uint8_t>> Binary;
 };
 
+struct CompilerInput
+{
+	const char* Code = nullptr;
+	ShaderStageType ShaderStage = ShaderStageType::Vertex;
+};
+
 class Compiler : public ReferenceObject
 {
 private:
@@ -23,6 +29,19 @@ public:
 	virtual void Initialize();
 	virtual void Compile(CompilerResult& result, const char* code, ShaderStageType shaderStage);
 
+	/**
+		@brief	compile codes and store results in the same order
+		@note
+		Codes are compiled in parallel if the compiler supports it. Otherwise, they are compiled one by one.
+	*/
+	virtual void CompileBatch(std::vector<CompilerResult>& results, const std::vector<CompilerInput>& inputs);
+
+	/**
+		@brief	store compiled binaries in a directory and reuse them when the same code is compiled (Vulkan only)
+		@param	directory	an existing directory. If it is null or empty, the cache is disabled.
+	*/
+	virtual void SetCacheDirectory(const char* directory);
+
 	virtual DeviceType GetDeviceType() const { return DeviceType::Default; }
 };
 
@@ -316,14 +316,20 @@ RenderPassPipelineStateKey RenderPass::GetKey() const
 	key.HasResolvedRenderTarget = GetResolvedRenderTexture() != nullptr;
 	key.HasResolvedDepthTarget = GetResolvedDepthTexture() != nullptr;
 
+	// contents are discarded only if all render targets are transient
+	key.IsColorTransient = !key.IsPresent;
+
 	for (size_t i = 0; i < key.RenderTargetFormats.size(); i++)
 	{
-		key.RenderTargetFormats.at(i) = GetRenderTexture(static_cast<int32_t>(i))->GetFormat();
+		auto texture = GetRenderTexture(static_cast<int32_t>(i));
+		key.RenderTargetFormats.at(i) = texture->GetFormat();
+		key.IsColorTransient &= (texture->GetUsage() & TextureUsageType::Transient) != TextureUsageType::NoneFlag;
 	}
 
 	if (GetHasDepthTexture())
 	{
 		key.DepthFormat = GetDepthTexture()->GetFormat();
+		key.IsDepthTransient = (GetDepthTexture()->GetUsage() & TextureUsageType::Transient) != TextureUsageType::NoneFlag;
 	}
 	else
 	{
@@ -357,6 +363,8 @@ SingleFrameMemoryPool* Graphics::CreateSingleFrameMemoryPool(int32_t constantBuf
 
 CommandList* Graphics::CreateCommandList(SingleFrameMemoryPool* memoryPool) { return nullptr; }
 
+CommandList* Graphics::CreateComputeCommandList(SingleFrameMemoryPool* memoryPool) { return CreateCommandList(memoryPool); }
+
 Texture* Graphics::CreateTexture(uint64_t id) { return nullptr; }
 
 RenderPassPipelineState* Graphics::CreateRenderPassPipelineState(RenderPass* renderPass) { return nullptr; }
@@ -18,6 +18,32 @@ struct TextureParameter
 	Vec3I Size = Vec3I{1, 1, 1};
 	int32_t MipLevelCount = 1;
 	int SampleCount = 1;
+
+	bool operator==(const TextureParameter& value) const
+	{
+		return (Usage == value.Usage && Format == value.Format && Dimension == value.Dimension && Size == value.Size &&
+				MipLevelCount == value.MipLevelCount && SampleCount == value.SampleCount);
+	}
+
+	bool operator!=(const TextureParameter& value) const { return !(*this == value); }
+
+	struct Hash
+	{
+		typedef std::size_t result_type;
+
+		std::size_t operator()(const TextureParameter& key) const
+		{
+			auto ret = std::hash<uint32_t>()(static_cast<uint32_t>(key.Usage));
+			ret += std::hash<TextureFormatType>()(key.Format);
+			ret += std::hash<int32_t>()(key.Dimension);
+			ret += std::hash<int32_t>()(key.Size.X) * 31;
+			ret += std::hash<int32_t>()(key.Size.Y) * 17;
+			ret += std::hash<int32_t>()(key.Size.Z);
+			ret += std::hash<int32_t>()(key.MipLevelCount);
+			ret += std::hash<int32_t>()(key.SampleCount);
+			return ret;
+		}
+	};
 };
 
 struct TextureInitializationParameter
@@ -89,6 +115,8 @@ struct RenderPassPipelineStateKey
 	bool IsDepthCleared = true;
 	bool HasResolvedRenderTarget = false;
 	bool HasResolvedDepthTarget = false;
+	bool IsColorTransient = false;
+	bool IsDepthTransient = false;
 	int32_t SamplingCount = 1;
 
 	bool operator==(const RenderPassPipelineStateKey& value) const
@@ -104,7 +132,8 @@ struct RenderPassPipelineStateKey
 
 		return (IsPresent == value.IsPresent && DepthFormat == value.DepthFormat && IsColorCleared == value.IsColorCleared &&
 				IsDepthCleared == value.IsDepthCleared && SamplingCount == value.SamplingCount &&
-				HasResolvedRenderTarget == value.HasResolvedRenderTarget && HasResolvedDepthTarget == value.HasResolvedDepthTarget);
+				HasResolvedRenderTarget == value.HasResolvedRenderTarget && HasResolvedDepthTarget == value.HasResolvedDepthTarget &&
+				IsColorTransient == value.IsColorTransient && IsDepthTransient == value.IsDepthTransient);
 	}
 
 	bool operator!=(const RenderPassPipelineStateKey& value) const { return !(*this == value); }
@@ -122,6 +151,8 @@ struct RenderPassPipelineStateKey
 			ret += std::hash<int32_t>()(key.SamplingCount);
 			ret += std::hash<bool>()(key.HasResolvedRenderTarget);
 			ret += std::hash<bool>()(key.HasResolvedDepthTarget);
+			ret += std::hash<bool>()(key.IsColorTransient);
+			ret += std::hash<bool>()(key.IsDepthTransient);
 
 			for (size_t i = 0; i < key.RenderTargetFormats.size(); i++)
 			{
@@ -233,6 +264,14 @@ public:
 	*/
 	virtual void Execute(CommandList* commandList);
 
+	/**
+		@brief	submit executed command lists to GPU
+		@note
+		Some backends collect executed command lists and submit them together at the end of a frame.
+		Waiting command lists, Platform::Present and WaitFinish submit them, so it is required only to start commands earlier.
+	*/
+	virtual void Flush() {}
+
 	/**
 	@brief	to prevent instances to be disposed before finish rendering, finish all renderings.
 	*/
@@ -243,6 +282,16 @@ public:
 	virtual Shader* CreateShader(DataStructure* data, int32_t count);
 	virtual PipelineState* CreatePiplineState();
 
+	/**
+		@brief	compile pipelines in a manifest in parallel to avoid hitches when they are used first
+		@param	shaders	shaders which are used by pipelines. Pipelines whose shaders are not specified are ignored.
+		@return	the number of compiled pipelines
+		@note
+		It blocks until compilations are finished, so call it while loading.
+		A manifest is recorded with PlatformParameter::PipelineManifestPath (Vulkan only).
+	*/
+	virtual int32_t PrewarmPipelines(const char* manifestPath, Shader** shaders, int32_t shaderCount) { return 0; }
+
 	/**
 		@brief create a memory pool
 		@param  drawingCount(drawingCount is ignored in DirectX12)
@@ -255,6 +304,15 @@ public:
 	*/
 	virtual CommandList* CreateCommandList(SingleFrameMemoryPool* memoryPool);
 
+	/**
+		@brief	create a command list which only records copies and compute passes
+		@note
+		It is executed on a compute queue if the device has it, so it may run in parallel with command lists for rendering.
+		Use CommandList::WaitCommandList to order it with other command lists.
+		If a backend doesn't support compute queues, it returns a normal command list.
+	*/
+	virtual CommandList* CreateComputeCommandList(SingleFrameMemoryPool* memoryPool);
+
 	virtual RenderPass* CreateRenderPass(Texture** textures, int32_t textureCount, Texture* depthTexture) { return nullptr; }
 
 	virtual RenderPass* CreateRenderPass(Texture* texture, Texture* resolvedTexture, Texture* depthTexture, Texture* resolvedDepthTexture)
@@ -7,6 +7,8 @@ namespace LLGI
 
 PipelineState::PipelineState() { VertexLayoutSemantics.fill(0); }
 
+PipelineState::~PipelineState() { SafeRelease(fallback_); }
+
 void PipelineState::SetShader(ShaderStageType stage, Shader* shader) {}
 
 RenderPassPipelineState* PipelineState::GetRenderPassPipelineState() const { return renderPassPipelineState_.get(); }
@@ -19,4 +21,26 @@ void PipelineState::SetRenderPassPipelineState(RenderPassPipelineState* renderPa
 
 bool PipelineState::Compile() { return false; }
 
+void PipelineState::SetFallback(PipelineState* fallback) { SafeAssign(fallback_, fallback); }
+
+PipelineState* PipelineState::GetAvailablePipelineState()
+{
+	if (IsReady())
+	{
+		return this;
+	}
+
+	if (NotReadyPolicy == PipelineNotReadyPolicy::Wait)
+	{
+		return WaitUntilReady() ? this : nullptr;
+	}
+
+	if (NotReadyPolicy == PipelineNotReadyPolicy::Fallback && fallback_ != nullptr && fallback_->IsReady())
+	{
+		return fallback_;
+	}
+
+	return nullptr;
+}
+
 } // namespace LLGI
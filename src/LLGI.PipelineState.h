@@ -6,14 +6,32 @@
 namespace LLGI
 {
 
+/**
+	@brief	what draws and dispatches do while a pipeline state is compiled asynchronously
+*/
+enum class PipelineNotReadyPolicy
+{
+	//! the draw is skipped
+	Skip,
+
+	//! a fallback pipeline state is used if it is ready. Otherwise, the draw is skipped.
+	Fallback,
+
+	//! the draw waits until the compilation is finished
+	Wait,
+};
+
 class PipelineState : public ReferenceObject
 {
+private:
+	PipelineState* fallback_ = nullptr;
+
 protected:
 	std::shared_ptr<RenderPassPipelineState> renderPassPipelineState_ = nullptr;
 
 public:
 	PipelineState();
-	~PipelineState() override = default;
+	~PipelineState() override;
 
 	CullingMode Culling = CullingMode::Clockwise;
 	TopologyType Topology = TopologyType::Triangle;
@@ -51,6 +69,8 @@ public:
 	std::array<int32_t, VertexLayoutMax> VertexLayoutSemantics;
 	int32_t VertexLayoutCount = 0;
 
+	PipelineNotReadyPolicy NotReadyPolicy = PipelineNotReadyPolicy::Skip;
+
 	virtual void SetShader(ShaderStageType stage, Shader* shader);
 
 	virtual RenderPassPipelineState* GetRenderPassPipelineState() const;
@@ -58,6 +78,38 @@ public:
 	virtual void SetRenderPassPipelineState(RenderPassPipelineState* renderPassPipelineState);
 
 	virtual bool Compile();
+
+	/**
+		@brief	start to compile on worker threads and return immediately
+		@note
+		States and shaders must not be changed until the compilation is finished.
+		It compiles synchronously on platforms which don't support it.
+	*/
+	virtual bool CompileAsync() { return Compile(); }
+
+	/**
+		@brief	whether the compilation is finished successfully. It doesn't block.
+	*/
+	virtual bool IsReady() const { return true; }
+
+	/**
+		@brief	wait until the compilation is finished
+		@return	whether it is compiled successfully
+	*/
+	virtual bool WaitUntilReady() { return IsReady(); }
+
+	/**
+		@brief	specify a pipeline state which is used with PipelineNotReadyPolicy::Fallback
+	*/
+	void SetFallback(PipelineState* fallback);
+
+	PipelineState* GetFallback() const { return fallback_; }
+
+	/**
+		@brief	get a pipeline state which is used for a draw according to NotReadyPolicy
+		@return	null if the draw should be skipped
+	*/
+	PipelineState* GetAvailablePipelineState();
 };
 
 } // namespace LLGI
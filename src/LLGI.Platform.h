@@ -14,6 +14,36 @@ struct PlatformParameter
 {
 	DeviceType Device = DeviceType::Default;
 	bool WaitVSync = true;
+
+	//! the number of frames which CPU can record ahead of GPU (Vulkan only)
+	int32_t FrameCountInFlight = 2;
+
+	//! milliseconds to wait for a swap buffer in NewFrame. A negative value means infinite. (Vulkan only)
+	int32_t AcquireTimeout = -1;
+
+	//! call vkQueueSubmit and vkQueuePresentKHR on a dedicated thread to hide the latency of a driver (Vulkan only)
+	bool UseSubmissionThread = false;
+
+	/**
+		@brief	create a device without a surface and a swapchain to render offscreen (Vulkan only)
+		@note
+		A window can be null. NewFrame and Present only pace frames and submit command lists, and GetCurrentScreen returns an invalid render pass.
+	*/
+	bool Headless = false;
+
+	/**
+		@brief	a file which the pipeline cache is loaded from in initialization and saved to in destruction (Vulkan only)
+		@note
+		Pipeline states are compiled faster in later runs. A file which is saved on another device or driver is ignored.
+	*/
+	std::string PipelineCachePath;
+
+	/**
+		@brief	a file which descriptions of compiled pipelines are recorded to in destruction (Vulkan only)
+		@note
+		Descriptions are accumulated over runs. Pass the file to Graphics::PrewarmPipelines to compile them while loading.
+	*/
+	std::string PipelineManifestPath;
 };
 
 Window* CreateWindow(const char* title, Vec2I windowSize);
@@ -46,6 +76,14 @@ public:
 
 	bool GetWaitVSync() const { return waitVSync_; }
 
+	/**
+		@brief	whether a swap buffer is not acquired in the current frame
+		@note
+		It becomes true when NewFrame times out or a swapchain is recreated.
+		GetCurrentScreen returns an invalid render pass and Present doesn't show anything in the frame.
+	*/
+	virtual bool GetIsFrameSkipped() const { return false; }
+
 	/**
 		@brief get render pass of screen to show on a display.
 		@note
@@ -0,0 +1,289 @@
+#include "LLGI.ShaderBundle.h"
+#include "LLGI.Graphics.h"
+#include "LLGI.Shader.h"
+#include <string.h>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace LLGI
+{
+
+namespace
+{
+
+int CompareEntry(const char* target, const char* name, const char* variant, const char* target2, const char* name2, const char* variant2)
+{
+	auto result = strcmp(target, target2);
+	if (result != 0)
+	{
+		return result;
+	}
+
+	result = strcmp(name, name2);
+	if (result != 0)
+	{
+		return result;
+	}
+
+	return strcmp(variant, variant2);
+}
+
+} // namespace
+
+const char* ShaderBundle::GetString(uint32_t offset) const { return reinterpret_cast<const char*>(data_ + offset); }
+
+bool ShaderBundle::IsReflectionValid(uint32_t offset) const
+{
+	if (offset % sizeof(uint32_t) != 0 || offset > size_ || size_ - offset < sizeof(ShaderBundleReflection))
+	{
+		return false;
+	}
+
+	const auto reflection = reinterpret_cast<const ShaderBundleReflection*>(data_ + offset);
+	const auto size = (size_ - offset - sizeof(ShaderBundleReflection));
+	if (size / sizeof(ShaderBundleUniform) < reflection->UniformCount ||
+		(size - sizeof(ShaderBundleUniform) * reflection->UniformCount) / sizeof(ShaderBundleTexture) < reflection->TextureCount)
+	{
+		return false;
+	}
+
+	const auto uniforms = GetUniforms(reflection);
+	for (uint32_t i = 0; i < reflection->UniformCount; i++)
+	{
+		if (uniforms[i].NameOffset >= size_)
+		{
+			return false;
+		}
+	}
+
+	const auto textures = GetTextures(reflection);
+	for (uint32_t i = 0; i < reflection->TextureCount; i++)
+	{
+		if (textures[i].NameOffset >= size_)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+ShaderBundle::~ShaderBundle()
+{
+#ifdef _WIN32
+	if (data_ != nullptr)
+	{
+		UnmapViewOfFile(data_);
+	}
+
+	if (mapping_ != nullptr)
+	{
+		CloseHandle(mapping_);
+	}
+
+	if (file_ != nullptr)
+	{
+		CloseHandle(file_);
+	}
+#else
+	if (data_ != nullptr)
+	{
+		munmap(const_cast<uint8_t*>(data_), size_);
+	}
+#endif
+}
+
+bool ShaderBundle::Initialize(const char* path)
+{
+#ifdef _WIN32
+	auto file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		Log(LogType::Error, std::string("Failed to open a shader bundle : ") + path);
+		return false;
+	}
+	file_ = file;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart < static_cast<LONGLONG>(sizeof(ShaderBundleHeader)))
+	{
+		Log(LogType::Error, std::string("A shader bundle is broken : ") + path);
+		return false;
+	}
+	size_ = static_cast<size_t>(fileSize.QuadPart);
+
+	mapping_ = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping_ == nullptr)
+	{
+		Log(LogType::Error, std::string("Failed to map a shader bundle : ") + path);
+		return false;
+	}
+
+	data_ = static_cast<const uint8_t*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+	if (data_ == nullptr)
+	{
+		Log(LogType::Error, std::string("Failed to map a shader bundle : ") + path);
+		return false;
+	}
+#else
+	auto file = open(path, O_RDONLY);
+	if (file < 0)
+	{
+		Log(LogType::Error, std::string("Failed to open a shader bundle : ") + path);
+		return false;
+	}
+
+	struct stat fileStat;
+	if (fstat(file, &fileStat) != 0 || fileStat.st_size < static_cast<off_t>(sizeof(ShaderBundleHeader)))
+	{
+		Log(LogType::Error, std::string("A shader bundle is broken : ") + path);
+		close(file);
+		return false;
+	}
+
+	// a mapping is kept after the file is closed
+	auto size = static_cast<size_t>(fileStat.st_size);
+	auto data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+	close(file);
+
+	if (data == MAP_FAILED)
+	{
+		Log(LogType::Error, std::string("Failed to map a shader bundle : ") + path);
+		return false;
+	}
+
+	data_ = static_cast<const uint8_t*>(data);
+	size_ = size;
+#endif
+
+	const auto header = reinterpret_cast<const ShaderBundleHeader*>(data_);
+	if (memcmp(header->Magic, ShaderBundleMagic, sizeof(ShaderBundleMagic)) != 0 || header->Version != ShaderBundleVersion)
+	{
+		Log(LogType::Error, std::string("A shader bundle has a different format : ") + path);
+		return false;
+	}
+
+	// a bundle ends with zero, so all strings are terminated in it
+	if ((size_ - sizeof(ShaderBundleHeader)) / sizeof(ShaderBundleEntry) < header->EntryCount || data_[size_ - 1] != 0)
+	{
+		Log(LogType::Error, std::string("A shader bundle is broken : ") + path);
+		return false;
+	}
+
+	entries_ = reinterpret_cast<const ShaderBundleEntry*>(data_ + sizeof(ShaderBundleHeader));
+	entryCount_ = header->EntryCount;
+
+	for (uint32_t i = 0; i < entryCount_; i++)
+	{
+		const auto& entry = entries_[i];
+		if (entry.TargetOffset >= size_ || entry.NameOffset >= size_ || entry.VariantOffset >= size_ || entry.DataOffset > size_ ||
+			entry.DataSize >= size_ - entry.DataOffset || entry.ShaderStage >= static_cast<uint32_t>(ShaderStageType::Max))
+		{
+			Log(LogType::Error, std::string("A shader bundle is broken : ") + path);
+			return false;
+		}
+
+		if (entry.ReflectionOffset != 0 && !IsReflectionValid(entry.ReflectionOffset))
+		{
+			Log(LogType::Error, std::string("A shader bundle is broken : ") + path);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+const ShaderBundleEntry* ShaderBundle::Find(const char* target, const char* name, const char* variant) const
+{
+	if (variant == nullptr)
+	{
+		variant = "";
+	}
+
+	uint32_t begin = 0;
+	uint32_t end = entryCount_;
+
+	while (begin < end)
+	{
+		const auto middle = begin + (end - begin) / 2;
+		const auto& entry = entries_[middle];
+		const auto result = CompareEntry(target, name, variant, GetTarget(&entry), GetName(&entry), GetVariant(&entry));
+
+		if (result == 0)
+		{
+			return &entry;
+		}
+		else if (result < 0)
+		{
+			end = middle;
+		}
+		else
+		{
+			begin = middle + 1;
+		}
+	}
+
+	return nullptr;
+}
+
+DataStructure ShaderBundle::GetData(const ShaderBundleEntry* entry) const
+{
+	DataStructure data;
+	data.Data = data_ + entry->DataOffset;
+	data.Size = static_cast<int32_t>(entry->DataSize);
+	return data;
+}
+
+const ShaderBundleReflection* ShaderBundle::GetReflection(const ShaderBundleEntry* entry) const
+{
+	if (entry->ReflectionOffset == 0)
+	{
+		return nullptr;
+	}
+
+	return reinterpret_cast<const ShaderBundleReflection*>(data_ + entry->ReflectionOffset);
+}
+
+const ShaderBundleUniform* ShaderBundle::GetUniforms(const ShaderBundleReflection* reflection) const
+{
+	return reinterpret_cast<const ShaderBundleUniform*>(reflection + 1);
+}
+
+const ShaderBundleTexture* ShaderBundle::GetTextures(const ShaderBundleReflection* reflection) const
+{
+	return reinterpret_cast<const ShaderBundleTexture*>(GetUniforms(reflection) + reflection->UniformCount);
+}
+
+Shader* ShaderBundle::CreateShader(Graphics* graphics, const char* target, const char* name, const char* variant) const
+{
+	auto entry = Find(target, name, variant);
+	if (entry == nullptr)
+	{
+		Log(LogType::Error, std::string("A shader is not found in a shader bundle : ") + target + " " + name);
+		return nullptr;
+	}
+
+	auto data = GetData(entry);
+	return graphics->CreateShader(&data, 1);
+}
+
+ShaderBundle* CreateShaderBundle(const char* path)
+{
+	auto bundle = new ShaderBundle();
+	if (!bundle->Initialize(path))
+	{
+		SafeRelease(bundle);
+		return nullptr;
+	}
+
+	return bundle;
+}
+
+} // namespace LLGI
@@ -0,0 +1,163 @@
+#pragma once
+
+#include "LLGI.Base.h"
+
+namespace LLGI
+{
+
+class Graphics;
+class Shader;
+
+static const char ShaderBundleMagic[4] = {'L', 'L', 'S', 'B'};
+static const uint32_t ShaderBundleVersion = 2;
+
+//! alignment of data in a bundle. SPIR-V requires 4 bytes.
+static const uint32_t ShaderBundleAlignment = 16;
+
+/**
+	@brief	a header at the beginning of a bundle, which is followed by entries
+*/
+struct ShaderBundleHeader
+{
+	char Magic[4];
+	uint32_t Version;
+	uint32_t EntryCount;
+	uint32_t Reserved;
+};
+
+/**
+	@brief	an entry of a bundle
+	@note
+	Offsets are from the beginning of a bundle. Strings and data are terminated with zero, which is not contained in DataSize.
+	Entries are sorted by target, name and variant to find them with a binary search.
+*/
+struct ShaderBundleEntry
+{
+	//! a target such as "SPIRV", "HLSL_DX12" or "Metal"
+	uint32_t TargetOffset;
+
+	//! a file name of a shader such as "simple_rectangle.vert"
+	uint32_t NameOffset;
+
+	//! a key of variant such as "NAME=VALUE,NAME=VALUE". It is empty if a shader has no variant.
+	uint32_t VariantOffset;
+
+	//! ShaderStageType
+	uint32_t ShaderStage;
+
+	uint32_t DataOffset;
+	uint32_t DataSize;
+
+	//! an offset of ShaderBundleReflection. It is zero if a shader has no reflection.
+	uint32_t ReflectionOffset;
+};
+
+/**
+	@brief	reflection of a shader, which is followed by uniforms and textures
+	@note
+	It is read from SPIR-V of a shader and shared by all targets with the same name and variant.
+*/
+struct ShaderBundleReflection
+{
+	uint32_t UniformCount;
+	uint32_t TextureCount;
+
+	//! numthreads of a compute shader
+	int32_t NumThreads[3];
+	uint32_t Reserved;
+};
+
+struct ShaderBundleUniform
+{
+	uint32_t NameOffset;
+	int32_t Offset;
+	int32_t Size;
+};
+
+struct ShaderBundleTexture
+{
+	uint32_t NameOffset;
+
+	//! a binding of a texture
+	int32_t Offset;
+};
+
+/**
+	@brief	shaders which are packed into a file by ShaderTranspiler --bundle
+	@note
+	A file is mapped into memory and shaders are created from it without copying, so loading many shaders requires a single file open.
+	Data must not be used after a bundle is released.
+*/
+class ShaderBundle : public ReferenceObject
+{
+private:
+	const uint8_t* data_ = nullptr;
+	size_t size_ = 0;
+	const ShaderBundleEntry* entries_ = nullptr;
+	uint32_t entryCount_ = 0;
+
+#ifdef _WIN32
+	void* file_ = nullptr;
+	void* mapping_ = nullptr;
+#endif
+
+	const char* GetString(uint32_t offset) const;
+
+	//! whether uniforms and textures of reflection are in a bundle
+	bool IsReflectionValid(uint32_t offset) const;
+
+public:
+	ShaderBundle() = default;
+	~ShaderBundle() override;
+
+	bool Initialize(const char* path);
+
+	/**
+		@param	variant	a key of variant. Null or empty is a shader without variants.
+		@return	null if a shader is not found
+	*/
+	const ShaderBundleEntry* Find(const char* target, const char* name, const char* variant = nullptr) const;
+
+	/**
+		@brief	get data of an entry which points into a mapped file
+	*/
+	DataStructure GetData(const ShaderBundleEntry* entry) const;
+
+	/**
+		@brief	get reflection of an entry which points into a mapped file
+		@return	null if an entry has no reflection
+	*/
+	const ShaderBundleReflection* GetReflection(const ShaderBundleEntry* entry) const;
+
+	const ShaderBundleUniform* GetUniforms(const ShaderBundleReflection* reflection) const;
+
+	const ShaderBundleTexture* GetTextures(const ShaderBundleReflection* reflection) const;
+
+	/**
+		@brief	create a shader from an entry
+		@return	null if a shader is not found or failed to be created
+	*/
+	Shader* CreateShader(Graphics* graphics, const char* target, const char* name, const char* variant = nullptr) const;
+
+	int32_t GetEntryCount() const { return static_cast<int32_t>(entryCount_); }
+
+	const ShaderBundleEntry* GetEntry(int32_t index) const { return &entries_[index]; }
+
+	const char* GetTarget(const ShaderBundleEntry* entry) const { return GetString(entry->TargetOffset); }
+
+	const char* GetName(const ShaderBundleEntry* entry) const { return GetString(entry->NameOffset); }
+
+	const char* GetVariant(const ShaderBundleEntry* entry) const { return GetString(entry->VariantOffset); }
+
+	const char* GetName(const ShaderBundleUniform* uniform) const { return GetString(uniform->NameOffset); }
+
+	const char* GetName(const ShaderBundleTexture* texture) const { return GetString(texture->NameOffset); }
+};
+
+/**
+	@brief	map a bundle into memory
+	@return	null if a file is not found or broken
+*/
+ShaderBundle* CreateShaderBundle(const char* path);
+
+} // namespace LLGI
@@ -14,6 +14,7 @@ protected:
 	TextureFormatType format_ = TextureFormatType::Unknown;
 	int32_t samplingCount_ = 1;
 	int32_t mipmapCount_ = 1;
+	TextureUsageType usage_ = TextureUsageType::NoneFlag;
 
 public:
 	Texture() = default;
@@ -44,6 +45,8 @@ public:
 	int32_t GetSamplingCount() const { return samplingCount_; }
 
 	int32_t GetMipmapCount() const { return mipmapCount_; }
+
+	TextureUsageType GetUsage() const { return usage_; }
 };
 
 } // namespace LLGI
@@ -15,6 +15,7 @@ bool TextureMetal::Initialize(id<MTLDevice> device, const TextureParameter& para
 	const bool isRenderTarget = (parameter.Usage & TextureUsageType::RenderTarget) != TextureUsageType::NoneFlag;
 
 	type_ = TextureType::Color;
+	usage_ = parameter.Usage;
 
 	if (IsDepthFormat(parameter.Format))
 	{
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <stddef.h>
+#include <utility>
+
+namespace LLGI
+{
+
+/**
+	@brief	a bounded ring buffer which is shared by one producer thread and one consumer thread without locks
+	@note
+	The capacity is N - 1 because one element is kept empty to distinguish a full queue from an empty one.
+*/
+template <typename T, size_t N> class LockFreeQueue
+{
+private:
+	std::array<T, N> items_;
+
+	//! written only by the consumer
+	std::atomic<size_t> head_;
+
+	//! written only by the producer
+	std::atomic<size_t> tail_;
+
+public:
+	LockFreeQueue() : head_(0), tail_(0) {}
+
+	/**
+		@brief	called by the producer
+		@return	false if the queue is full. In this case, the item is not moved.
+	*/
+	bool Push(T& item)
+	{
+		const auto tail = tail_.load(std::memory_order_relaxed);
+		const auto next = (tail + 1) % N;
+
+		if (next == head_.load(std::memory_order_acquire))
+		{
+			return false;
+		}
+
+		items_[tail] = std::move(item);
+		tail_.store(next, std::memory_order_release);
+		return true;
+	}
+
+	/**
+		@brief	called by the consumer
+		@return	false if the queue is empty
+	*/
+	bool Pop(T& item)
+	{
+		const auto head = head_.load(std::memory_order_relaxed);
+
+		if (head == tail_.load(std::memory_order_acquire))
+		{
+			return false;
+		}
+
+		item = std::move(items_[head]);
+		items_[head] = T();
+		head_.store((head + 1) % N, std::memory_order_release);
+		return true;
+	}
+
+	bool IsEmpty() const { return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire); }
+
+	bool IsFull() const { return (tail_.load(std::memory_order_acquire) + 1) % N == head_.load(std::memory_order_acquire); }
+
+	//! the number of items which can be pushed. It is exact for the producer because only the consumer increases it.
+	size_t GetFreeCount() const
+	{
+		return (head_.load(std::memory_order_acquire) + N - 1 - tail_.load(std::memory_order_acquire)) % N;
+	}
+};
+
+} // namespace LLGI
@@ -0,0 +1,256 @@
+#pragma once
+
+#include "../LLGI.Graphics.h"
+#include "../LLGI.Texture.h"
+#include <unordered_map>
+
+namespace LLGI
+{
+
+/**
+	@brief	a pool of render textures and render passes which are used as intermediate targets in a frame
+	@note
+	Textures which are got from the pool are returned when NewFrame is called.
+	They are reused after the number of frameCount has passed, because command lists may still use them.
+	Textures which are not used for unusedFrameCount frames are released.
+	A render pass keeps its clear settings, so specify them every time it is got.
+*/
+class RenderTargetPool
+{
+private:
+	struct TextureEntry
+	{
+		Texture* texture = nullptr;
+		int32_t returnedFrame = 0;
+	};
+
+	struct RenderPassKey
+	{
+		std::array<Texture*, RenderTargetMax> Textures;
+		int32_t TextureCount = 0;
+		Texture* DepthTexture = nullptr;
+
+		bool operator==(const RenderPassKey& value) const
+		{
+			if (TextureCount != value.TextureCount || DepthTexture != value.DepthTexture)
+				return false;
+
+			for (int32_t i = 0; i < TextureCount; i++)
+			{
+				if (Textures[i] != value.Textures[i])
+					return false;
+			}
+
+			return true;
+		}
+
+		bool Contains(Texture* texture) const
+		{
+			if (DepthTexture == texture)
+				return true;
+
+			for (int32_t i = 0; i < TextureCount; i++)
+			{
+				if (Textures[i] == texture)
+					return true;
+			}
+
+			return false;
+		}
+
+		struct Hash
+		{
+			typedef std::size_t result_type;
+
+			std::size_t operator()(const RenderPassKey& key) const
+			{
+				auto ret = std::hash<Texture*>()(key.DepthTexture);
+				for (int32_t i = 0; i < key.TextureCount; i++)
+				{
+					ret += std::hash<Texture*>()(key.Textures[i]) * (i + 2);
+				}
+				return ret;
+			}
+		};
+	};
+
+	Graphics* graphics_ = nullptr;
+	int32_t frameCount_ = 0;
+	int32_t unusedFrameCount_ = 0;
+	int32_t currentFrame_ = 0;
+
+	std::unordered_map<TextureParameter, std::vector<TextureEntry>, TextureParameter::Hash> freeTextures_;
+	std::vector<std::pair<TextureParameter, Texture*>> usedTextures_;
+	std::unordered_map<RenderPassKey, RenderPass*, RenderPassKey::Hash> renderPasses_;
+
+	void ReleaseTexture(Texture* texture)
+	{
+		for (auto it = renderPasses_.begin(); it != renderPasses_.end();)
+		{
+			if (it->first.Contains(texture))
+			{
+				it->second->Release();
+				it = renderPasses_.erase(it);
+			}
+			else
+			{
+				it++;
+			}
+		}
+
+		texture->Release();
+	}
+
+public:
+	RenderTargetPool(Graphics* graphics, int32_t frameCount = 3, int32_t unusedFrameCount = 60)
+		: frameCount_(frameCount), unusedFrameCount_(unusedFrameCount)
+	{
+		SafeAssign(graphics_, graphics);
+	}
+
+	~RenderTargetPool()
+	{
+		for (auto& rp : renderPasses_)
+		{
+			rp.second->Release();
+		}
+		renderPasses_.clear();
+
+		for (auto& t : usedTextures_)
+		{
+			t.second->Release();
+		}
+		usedTextures_.clear();
+
+		for (auto& ts : freeTextures_)
+		{
+			for (auto& t : ts.second)
+			{
+				t.texture->Release();
+			}
+		}
+		freeTextures_.clear();
+
+		SafeRelease(graphics_);
+	}
+
+	/**
+		@brief	get a texture which is valid until NewFrame is called
+		@note
+		A reference counter is not increased.
+	*/
+	Texture* GetTexture(const TextureParameter& parameter)
+	{
+		auto it = freeTextures_.find(parameter);
+		if (it != freeTextures_.end())
+		{
+			auto& entries = it->second;
+			for (size_t i = 0; i < entries.size(); i++)
+			{
+				if (entries[i].returnedFrame + frameCount_ > currentFrame_)
+				{
+					continue;
+				}
+
+				auto texture = entries[i].texture;
+				entries[i] = entries.back();
+				entries.pop_back();
+				usedTextures_.emplace_back(parameter, texture);
+				return texture;
+			}
+		}
+
+		auto texture = graphics_->CreateTexture(parameter);
+		if (texture == nullptr)
+		{
+			return nullptr;
+		}
+
+		usedTextures_.emplace_back(parameter, texture);
+		return texture;
+	}
+
+	/**
+		@brief	get a render pass for textures which are got from this pool
+		@note
+		A reference counter is not increased. The render pass is released with the textures.
+	*/
+	RenderPass* GetRenderPass(Texture** textures, int32_t textureCount, Texture* depthTexture)
+	{
+		if (textureCount < 0 || textureCount > RenderTargetMax)
+		{
+			Log(LogType::Error, "RenderTargetPool : textureCount is invalid.");
+			return nullptr;
+		}
+
+		RenderPassKey key;
+		key.Textures.fill(nullptr);
+		for (int32_t i = 0; i < textureCount; i++)
+		{
+			key.Textures[i] = textures[i];
+		}
+		key.TextureCount = textureCount;
+		key.DepthTexture = depthTexture;
+
+		auto it = renderPasses_.find(key);
+		if (it != renderPasses_.end())
+		{
+			return it->second;
+		}
+
+		auto renderPass = graphics_->CreateRenderPass(textures, textureCount, depthTexture);
+		if (renderPass == nullptr)
+		{
+			return nullptr;
+		}
+
+		renderPasses_[key] = renderPass;
+		return renderPass;
+	}
+
+	/**
+		@brief	return textures which are got in this frame and release textures which are not used for a while
+	*/
+	void NewFrame()
+	{
+		currentFrame_++;
+
+		for (auto& t : usedTextures_)
+		{
+			TextureEntry entry;
+			entry.texture = t.second;
+			entry.returnedFrame = currentFrame_;
+			freeTextures_[t.first].push_back(entry);
+		}
+		usedTextures_.clear();
+
+		for (auto it = freeTextures_.begin(); it != freeTextures_.end();)
+		{
+			auto& entries = it->second;
+			for (size_t i = 0; i < entries.size();)
+			{
+				if (entries[i].returnedFrame + unusedFrameCount_ < currentFrame_)
+				{
+					ReleaseTexture(entries[i].texture);
+					entries[i] = entries.back();
+					entries.pop_back();
+				}
+				else
+				{
+					i++;
+				}
+			}
+
+			if (entries.empty())
+			{
+				it = freeTextures_.erase(it);
+			}
+			else
+			{
+				it++;
+			}
+		}
+	}
+};
+
+} // namespace LLGI
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace LLGI
+{
+
+/**
+	@brief	threads which run tasks in the order they are added
+	@note
+	Tasks which are added are finished before the pool is destroyed, so every task is run once.
+	The pool can be destroyed by a task. In this case, the thread which runs it is detached and finishes after the task.
+*/
+class WorkerPool
+{
+private:
+	//! shared with threads because a detached thread uses it after the pool is destroyed
+	struct State
+	{
+		std::queue<std::function<void()>> tasks;
+		std::mutex mutex;
+		std::condition_variable condition;
+		bool isStopped = false;
+	};
+
+	std::vector<std::thread> threads_;
+	std::shared_ptr<State> state_;
+
+	static void Run(std::shared_ptr<State> state)
+	{
+		while (true)
+		{
+			std::function<void()> task;
+
+			{
+				std::unique_lock<std::mutex> lock(state->mutex);
+				state->condition.wait(lock, [&state]() { return state->isStopped || !state->tasks.empty(); });
+
+				if (state->tasks.empty())
+				{
+					return;
+				}
+
+				task = std::move(state->tasks.front());
+				state->tasks.pop();
+			}
+
+			task();
+		}
+	}
+
+public:
+	/**
+		@param	threadCount	the number of threads. If it is zero or less, it is decided by the number of cores.
+	*/
+	WorkerPool(int32_t threadCount = 0) : state_(std::make_shared<State>())
+	{
+		if (threadCount <= 0)
+		{
+			// leave a core for the thread which adds tasks
+			const auto coreCount = static_cast<int32_t>(std::thread::hardware_concurrency());
+			threadCount = coreCount > 1 ? coreCount - 1 : 1;
+		}
+
+		for (int32_t i = 0; i < threadCount; i++)
+		{
+			auto state = state_;
+			threads_.emplace_back([state]() { Run(state); });
+		}
+	}
+
+	~WorkerPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(state_->mutex);
+			state_->isStopped = true;
+		}
+		state_->condition.notify_all();
+
+		for (auto& thread : threads_)
+		{
+			// a thread cannot join itself
+			if (thread.get_id() == std::this_thread::get_id())
+			{
+				thread.detach();
+			}
+			else
+			{
+				thread.join();
+			}
+		}
+	}
+
+	WorkerPool(const WorkerPool&) = delete;
+	WorkerPool& operator=(const WorkerPool&) = delete;
+
+	void Enqueue(std::function<void()> task)
+	{
+		// the task may destroy the pool before it returns
+		auto state = state_;
+
+		{
+			std::lock_guard<std::mutex> lock(state->mutex);
+			state->tasks.push(std::move(task));
+		}
+		state->condition.notify_one();
+	}
+
+	int32_t GetThreadCount() const { return static_cast<int32_t>(threads_.size()); }
+};
+
+} // namespace LLGI
@@ -72,6 +72,15 @@ bool BufferVulkan::Initialize(GraphicsVulkan* graphics, BufferUsageType usage, i
 		vk::BufferCreateInfo ComputeBufferInfo;
 		ComputeBufferInfo.size = actualSize_;
 		ComputeBufferInfo.usage = vkUsage;
+
+		// buffers may be accessed from the compute queue without ownership transfers
+		const auto queueFamilyIndices = graphics_->GetConcurrentQueueFamilyIndices();
+		if (queueFamilyIndices.size() > 1)
+		{
+			ComputeBufferInfo.sharingMode = vk::SharingMode::eConcurrent;
+			ComputeBufferInfo.queueFamilyIndexCount = static_cast<uint32_t>(queueFamilyIndices.size());
+			ComputeBufferInfo.pQueueFamilyIndices = queueFamilyIndices.data();
+		}
 		vk::Buffer buffer = graphics_->GetDevice().createBuffer(ComputeBufferInfo);
 
 		vk::MemoryRequirements memReqs = graphics_->GetDevice().getBufferMemoryRequirements(buffer);
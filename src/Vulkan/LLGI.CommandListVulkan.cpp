@@ -2,6 +2,8 @@
 #include "LLGI.BufferVulkan.h"
 #include "LLGI.GraphicsVulkan.h"
 #include "LLGI.PipelineStateVulkan.h"
+#include "LLGI.ReadbackVulkan.h"
+#include "LLGI.SubmissionQueueVulkan.h"
 #include "LLGI.TextureVulkan.h"
 
 namespace LLGI
@@ -23,7 +25,7 @@ DescriptorPoolVulkan::DescriptorPoolVulkan(
 		vk::DescriptorPoolCreateInfo poolInfo;
 		poolInfo.poolSizeCount = 3;
 		poolInfo.pPoolSizes = poolSizes.data();
-		poolInfo.maxSets = slotSizeMax_;
+		poolInfo.maxSets = slotSizeMax_ * 3;
 
 		descriptorPool_ = graphics_->GetDevice().createDescriptorPool(poolInfo);
 	}
@@ -40,7 +42,7 @@ DescriptorPoolVulkan::DescriptorPoolVulkan(
 		vk::DescriptorPoolCreateInfo poolInfo;
 		poolInfo.poolSizeCount = 3;
 		poolInfo.pPoolSizes = poolSizes.data();
-		poolInfo.maxSets = slotSizeMax_;
+		poolInfo.maxSets = slotSizeMax_ * 3;
 
 		computeDescriptorPool_ = graphics_->GetDevice().createDescriptorPool(poolInfo);
 	}
@@ -61,64 +63,60 @@ DescriptorPoolVulkan ::~DescriptorPoolVulkan()
 	}
 }
 
-const std::vector<vk::DescriptorSet>& DescriptorPoolVulkan::Get(PipelineStateVulkan* pip)
+const std::vector<vk::DescriptorSet>& DescriptorPoolVulkan::Allocate(vk::DescriptorPool pool,
+																	 std::unordered_map<VkPipelineLayout, SetCache>& caches,
+																	 int32_t& allocatedCount,
+																	 vk::PipelineLayout pipelineLayout,
+																	 const std::array<vk::DescriptorSetLayout, 3>& layouts)
 {
-	if (cache.size() > static_cast<size_t>(offset))
+	// sets are shared by pipelines with the same stages because they use the same layout
+	auto& setCache = caches[static_cast<VkPipelineLayout>(pipelineLayout)];
+
+	if (setCache.sets.size() > static_cast<size_t>(setCache.offset))
 	{
-		offset++;
-		return cache[offset - 1];
+		setCache.offset++;
+		return setCache.sets[setCache.offset - 1];
 	}
 
-	if (offset >= slotSizeMax_)
+	if (allocatedCount >= slotSizeMax_)
 	{
 		Log(LogType::Warning, "Lack of allocated memory.");
 		return dummySet_;
 	}
 
-	// TODO : improve it
-	auto& layout = pip->GetDescriptorSetLayout();
 	vk::DescriptorSetAllocateInfo allocateInfo;
-	allocateInfo.descriptorPool = descriptorPool_;
-	allocateInfo.descriptorSetCount = static_cast<int>(layout.size());
-	allocateInfo.pSetLayouts = layout.data();
-
-	std::vector<vk::DescriptorSet> descriptorSets = graphics_->GetDevice().allocateDescriptorSets(allocateInfo);
-	cache.push_back(descriptorSets);
-	offset++;
-	return cache[offset - 1];
+	allocateInfo.descriptorPool = pool;
+	allocateInfo.descriptorSetCount = static_cast<int>(layouts.size());
+	allocateInfo.pSetLayouts = layouts.data();
+
+	setCache.sets.push_back(graphics_->GetDevice().allocateDescriptorSets(allocateInfo));
+	setCache.offset++;
+	allocatedCount++;
+	return setCache.sets[setCache.offset - 1];
+}
+
+const std::vector<vk::DescriptorSet>& DescriptorPoolVulkan::Get(PipelineStateVulkan* pip)
+{
+	return Allocate(descriptorPool_, cache, allocatedCount_, pip->GetPipelineLayout(), pip->GetDescriptorSetLayout());
 }
 
 const std::vector<vk::DescriptorSet>& DescriptorPoolVulkan::GetCompute(PipelineStateVulkan* pip)
 {
-	if (computeCache.size() > static_cast<size_t>(computeOffset))
+	return Allocate(
+		computeDescriptorPool_, computeCache, computeAllocatedCount_, pip->GetComputePipelineLayout(), pip->GetComputeDescriptorSetLayout());
+}
+
+void DescriptorPoolVulkan::Reset()
+{
+	for (auto& it : cache)
 	{
-		computeOffset++;
-		return computeCache[computeOffset - 1];
+		it.second.offset = 0;
 	}
 
-	if (computeOffset >= slotSizeMax_)
+	for (auto& it : computeCache)
 	{
-		Log(LogType::Warning, "Lack of allocated memory.");
-		return dummySet_;
+		it.second.offset = 0;
 	}
-
-	// TODO : improve it
-	auto& layout = pip->GetComputeDescriptorSetLayout();
-	vk::DescriptorSetAllocateInfo allocateInfo;
-	allocateInfo.descriptorPool = computeDescriptorPool_;
-	allocateInfo.descriptorSetCount = static_cast<int>(layout.size());
-	allocateInfo.pSetLayouts = layout.data();
-
-	std::vector<vk::DescriptorSet> descriptorSets = graphics_->GetDevice().allocateDescriptorSets(allocateInfo);
-	computeCache.push_back(descriptorSets);
-	computeOffset++;
-	return computeCache[computeOffset - 1];
-}
-
-void DescriptorPoolVulkan::Reset()
-{
-	offset = 0;
-	computeOffset = 0;
 }
 
 CommandListVulkan::CommandListVulkan() {}
@@ -127,21 +125,12 @@ CommandListVulkan::~CommandListVulkan()
 {
 	if (commandBuffers_.size() > 0)
 	{
-		graphics_->GetDevice().freeCommandBuffers(graphics_->GetCommandPool(), commandBuffers_);
+		graphics_->GetDevice().freeCommandBuffers(commandPool_, commandBuffers_);
 	}
 	commandBuffers_.clear();
 
 	descriptorPools.clear();
 
-	for (size_t i = 0; i < fences_.size(); i++)
-	{
-		if (fences_[i])
-		{
-			graphics_->GetDevice().destroyFence(fences_[i]);
-		}
-	}
-	fences_.clear();
-
 	for (int w = 0; w < 2; w++)
 	{
 		for (int f = 0; f < 2; f++)
@@ -154,13 +143,16 @@ CommandListVulkan::~CommandListVulkan()
 	}
 }
 
-bool CommandListVulkan::Initialize(GraphicsVulkan* graphics, int32_t drawingCount)
+bool CommandListVulkan::Initialize(GraphicsVulkan* graphics, int32_t drawingCount, bool isCompute)
 {
 	SafeAddRef(graphics);
 	graphics_ = CreateSharedPtr(graphics);
 
+	isCompute_ = isCompute;
+	commandPool_ = GetIsCompute() ? graphics->GetComputeCommandPool() : graphics->GetCommandPool();
+
 	vk::CommandBufferAllocateInfo allocInfo;
-	allocInfo.commandPool = graphics->GetCommandPool();
+	allocInfo.commandPool = commandPool_;
 	allocInfo.level = vk::CommandBufferLevel::ePrimary;
 	allocInfo.commandBufferCount = graphics->GetSwapBufferCount();
 	commandBuffers_ = graphics->GetDevice().allocateCommandBuffers(allocInfo);
@@ -170,7 +162,9 @@ bool CommandListVulkan::Initialize(GraphicsVulkan* graphics, int32_t drawingCoun
 		auto dp = std::make_shared<DescriptorPoolVulkan>(graphics_, drawingCount, 4, 8, 8);
 		descriptorPools.push_back(dp);
 
-		fences_.emplace_back(vk::Fence{});
+		swapBeginCounts_.emplace_back(0);
+		swapExecuted_.emplace_back(false);
+		swapValues_.emplace_back(0);
 	}
 
 	// Sampler
@@ -216,24 +210,19 @@ void CommandListVulkan::Begin()
 	currentSwapBufferIndex_++;
 	currentSwapBufferIndex_ %= commandBuffers_.size();
 
-	if (fences_[currentSwapBufferIndex_])
-	{
-		WaitUntilCompleted();
-	}
-	else
-	{
-		fences_[currentSwapBufferIndex_] = graphics_->GetDevice().createFence(vk::FenceCreateFlags());
-	}
+	// the command buffer may still be executed
+	WaitUntilCompleted();
 
-	const auto recetFencesResult = graphics_->GetDevice().resetFences(1, &(fences_[currentSwapBufferIndex_]));
-	if (recetFencesResult != vk::Result::eSuccess)
-	{
-		LLGI::Log(LogType::Error, "Failed to resetFences");
-		return;
-	}
+	beginCount_++;
+	swapBeginCounts_[currentSwapBufferIndex_] = beginCount_;
+	swapExecuted_[currentSwapBufferIndex_] = false;
+
+	waitTimelines_.clear();
 
 	currentCommandBuffer_ = commandBuffers_[currentSwapBufferIndex_];
 	currentCommandBuffer_.reset(vk::CommandBufferResetFlagBits::eReleaseResources);
+	boundPipeline_ = nullptr;
+	boundComputePipeline_ = nullptr;
 	vk::CommandBufferBeginInfo cmdBufInfo;
 	currentCommandBuffer_.begin(cmdBufInfo);
 
@@ -267,6 +256,14 @@ bool CommandListVulkan::BeginWithPlatform(void* platformContextPtr)
 void CommandListVulkan::EndWithPlatform()
 {
 	currentCommandBuffer_ = vk::CommandBuffer();
+
+	// the command buffer is submitted outside of Graphics::Execute after it, so pending transitions are submitted into the queue before
+	graphics_->FlushInitialLayoutTransitions();
+	if (!graphics_->GetSubmissionQueue()->FlushSynchronously())
+	{
+		Log(LogType::Error, "Failed to submit initial layout transitions.");
+	}
+
 	CommandList::EndWithPlatform();
 }
 
@@ -322,7 +319,13 @@ void CommandListVulkan::Draw(int32_t primitiveCount, int32_t instanceCount)
 
 	auto vb = static_cast<BufferVulkan*>(vb_.vertexBuffer);
 	auto ib = static_cast<BufferVulkan*>(ib_.indexBuffer);
-	auto pip = static_cast<PipelineStateVulkan*>(pip_);
+
+	// the pipeline state may be compiled asynchronously
+	auto pip = static_cast<PipelineStateVulkan*>(pip_->GetAvailablePipelineState());
+	if (pip == nullptr)
+	{
+		return;
+	}
 
 	if (renderPass_ != nullptr && pip->GetRenderPassPipelineState()->Key != renderPass_->GetKey())
 	{
@@ -374,8 +377,16 @@ void CommandListVulkan::Draw(int32_t primitiveCount, int32_t instanceCount)
 	std::array<vk::DescriptorImageInfo, NumTexture> descriptorImageInfos;
 	int descriptorImageIndex = 0;
 
+	// bindings which are not used by shaders are not written
+	const auto& bindingMasks = pip->GetBindingMasks();
+
 	for (size_t unit_ind = 0; unit_ind < constantBuffers_.size(); unit_ind++)
 	{
+		if ((bindingMasks[0] & (1u << unit_ind)) == 0)
+		{
+			continue;
+		}
+
 		auto cb = static_cast<BufferVulkan*>(constantBuffers_[unit_ind]);
 		if (cb == nullptr)
 		{
@@ -403,6 +414,9 @@ void CommandListVulkan::Draw(int32_t primitiveCount, int32_t instanceCount)
 	// Assign textures
 	for (int unit_ind = 0; unit_ind < static_cast<int32_t>(currentTextures_.size()); unit_ind++)
 	{
+		if ((bindingMasks[1] & (1u << unit_ind)) == 0)
+			continue;
+
 		if (currentTextures_[unit_ind].texture == nullptr)
 			continue;
 
@@ -443,6 +457,9 @@ void CommandListVulkan::Draw(int32_t primitiveCount, int32_t instanceCount)
 	// compute buffer
 	for (int unit_ind = 0; unit_ind < NumComputeBuffer; unit_ind++)
 	{
+		if ((bindingMasks[2] & (1u << unit_ind)) == 0)
+			continue;
+
 		BindingComputeBuffer cb_;
 		GetCurrentComputeBuffer(unit_ind, cb_);
 
@@ -474,16 +491,22 @@ void CommandListVulkan::Draw(int32_t primitiveCount, int32_t instanceCount)
 		graphics_->GetDevice().updateDescriptorSets(writeDescriptorIndex, writeDescriptorSets.data(), 0, nullptr);
 	}
 
-	std::array<uint32_t, 12> offsets;
+	std::array<uint32_t, NumConstantBuffer + NumComputeBuffer> offsets;
 	offsets.fill(0);
 
-	currentCommandBuffer_.bindDescriptorSets(
-		vk::PipelineBindPoint::eGraphics, pip->GetPipelineLayout(), 0, 3, descriptorSets.data(), 12, offsets.data());
+	currentCommandBuffer_.bindDescriptorSets(vk::PipelineBindPoint::eGraphics,
+											 pip->GetPipelineLayout(),
+											 0,
+											 3,
+											 descriptorSets.data(),
+											 static_cast<uint32_t>(offsets.size()),
+											 offsets.data());
 
 	// assign a pipeline
-	if (isPipDirtied)
+	if (isPipDirtied || boundPipeline_ != pip->GetPipeline())
 	{
 		currentCommandBuffer_.bindPipeline(vk::PipelineBindPoint::eGraphics, pip->GetPipeline());
+		boundPipeline_ = pip->GetPipeline();
 	}
 
 	// draw
@@ -525,6 +548,12 @@ void CommandListVulkan::CopyTexture(
 		return;
 	}
 
+	if (isCompute_)
+	{
+		Log(LogType::Error, "CopyTexture : textures are not supported in a compute command list.");
+		return;
+	}
+
 	auto srcTex = static_cast<TextureVulkan*>(src);
 	auto dstTex = static_cast<TextureVulkan*>(dst);
 
@@ -566,6 +595,12 @@ void CommandListVulkan::CopyTexture(
 
 void CommandListVulkan::GenerateMipMap(Texture* src)
 {
+	if (isCompute_)
+	{
+		Log(LogType::Error, "GenerateMipMap : textures are not supported in a compute command list.");
+		return;
+	}
+
 	auto srcTex = static_cast<TextureVulkan*>(src);
 
 	int32_t mipWidth = src->GetSizeAs2D().X;
@@ -620,8 +655,182 @@ void CommandListVulkan::CopyBuffer(Buffer* src, Buffer* dst)
 	currentCommandBuffer_.copyBuffer(srcGpuBuf, dstGpuBuf, copyRegion);
 }
 
+ReadbackToken* CommandListVulkan::ReadbackTexture(Texture* src, const Vec2I& position, const Vec2I& size)
+{
+	if (isInRenderPass_)
+	{
+		Log(LogType::Error, "Please call ReadbackTexture outside of RenderPass");
+		return nullptr;
+	}
+
+	if (isCompute_)
+	{
+		Log(LogType::Error, "ReadbackTexture : textures are not supported in a compute command list.");
+		return nullptr;
+	}
+
+	if (currentSwapBufferIndex_ < 0 || currentCommandBuffer_ != commandBuffers_[currentSwapBufferIndex_])
+	{
+		Log(LogType::Error, "ReadbackTexture : BeginWithPlatform is not supported.");
+		return nullptr;
+	}
+
+	auto srcTex = static_cast<TextureVulkan*>(src);
+
+	if (srcTex->GetType() == TextureType::Depth)
+	{
+		Log(LogType::Error, "ReadbackTexture : DepthTexture is not supported.");
+		return nullptr;
+	}
+
+	const auto textureSize = srcTex->GetSizeAs2D();
+	if (position.X < 0 || position.Y < 0 || size.X <= 0 || size.Y <= 0 || position.X + size.X > textureSize.X ||
+		position.Y + size.Y > textureSize.Y)
+	{
+		Log(LogType::Error, "ReadbackTexture : A region is out of the texture.");
+		return nullptr;
+	}
+
+	const auto rowPitch = GetTextureMemorySize(srcTex->GetFormat(), {size.X, 1, 1});
+	const auto dataSize = rowPitch * size.Y;
+	if (dataSize == 0)
+	{
+		return nullptr;
+	}
+
+	ReadbackBufferPoolVulkan::Block block;
+	if (!graphics_->GetReadbackBufferPool()->Acquire(dataSize, block))
+	{
+		return nullptr;
+	}
+
+	auto buffer = new ReadbackBufferVulkan(graphics_.get(), block);
+
+	auto oldLayout = srcTex->GetImageLayouts()[0];
+	srcTex->ResourceBarrier(0, currentCommandBuffer_, vk::ImageLayout::eTransferSrcOptimal);
+
+	vk::BufferImageCopy region;
+	region.bufferOffset = 0;
+	region.bufferRowLength = 0;
+	region.bufferImageHeight = 0;
+	region.imageSubresource.aspectMask = vk::ImageAspectFlagBits::eColor;
+	region.imageSubresource.mipLevel = 0;
+	region.imageSubresource.baseArrayLayer = 0;
+	region.imageSubresource.layerCount = 1;
+	region.imageOffset = vk::Offset3D(position.X, position.Y, 0);
+	region.imageExtent = vk::Extent3D(static_cast<uint32_t>(size.X), static_cast<uint32_t>(size.Y), 1);
+	currentCommandBuffer_.copyImageToBuffer(srcTex->GetImage(), vk::ImageLayout::eTransferSrcOptimal, buffer->GetBuffer(), region);
+
+	// an image which is not initialized can't go back to undefined
+	if (oldLayout != vk::ImageLayout::eUndefined)
+	{
+		srcTex->ResourceBarrier(0, currentCommandBuffer_, oldLayout);
+	}
+
+	// make the copied data visible to CPU after the fence is signaled
+	vk::BufferMemoryBarrier bufferBarrier;
+	bufferBarrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+	bufferBarrier.dstAccessMask = vk::AccessFlagBits::eHostRead;
+	bufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	bufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	bufferBarrier.buffer = buffer->GetBuffer();
+	bufferBarrier.offset = 0;
+	bufferBarrier.size = VK_WHOLE_SIZE;
+	currentCommandBuffer_.pipelineBarrier(
+		vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eHost, vk::DependencyFlags(), nullptr, bufferBarrier, nullptr);
+
+	RegisterReferencedObject(src);
+
+	// the block must not be reused until this command buffer is completed even if the token is released
+	RegisterReferencedObject(buffer);
+
+	auto token = new ReadbackTokenVulkan(this, buffer, dataSize, rowPitch);
+	SafeRelease(buffer);
+	return token;
+}
+
+ReadbackToken* CommandListVulkan::ReadbackBuffer(Buffer* src, int32_t offset, int32_t size)
+{
+	if (isInRenderPass_)
+	{
+		Log(LogType::Error, "Please call ReadbackBuffer outside of RenderPass");
+		return nullptr;
+	}
+
+	if (currentSwapBufferIndex_ < 0 || currentCommandBuffer_ != commandBuffers_[currentSwapBufferIndex_])
+	{
+		Log(LogType::Error, "ReadbackBuffer : BeginWithPlatform is not supported.");
+		return nullptr;
+	}
+
+	auto srcBuf = static_cast<BufferVulkan*>(src);
+
+	if (!BitwiseContains(srcBuf->GetBufferUsage(), BufferUsageType::CopySrc))
+	{
+		Log(LogType::Error, "ReadbackBuffer : CopySrc is required.");
+		return nullptr;
+	}
+
+	if (offset < 0 || size <= 0 || offset + size > srcBuf->GetSize())
+	{
+		Log(LogType::Error, "ReadbackBuffer : A range is out of the buffer.");
+		return nullptr;
+	}
+
+	ReadbackBufferPoolVulkan::Block block;
+	if (!graphics_->GetReadbackBufferPool()->Acquire(size, block))
+	{
+		return nullptr;
+	}
+
+	auto buffer = new ReadbackBufferVulkan(graphics_.get(), block);
+
+	// wait writes by shaders and copies which are recorded before
+	vk::BufferMemoryBarrier srcBarrier;
+	srcBarrier.srcAccessMask = vk::AccessFlagBits::eShaderWrite | vk::AccessFlagBits::eTransferWrite;
+	srcBarrier.dstAccessMask = vk::AccessFlagBits::eTransferRead;
+	srcBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	srcBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	srcBarrier.buffer = srcBuf->GetBuffer();
+	srcBarrier.offset = srcBuf->GetOffset() + offset;
+	srcBarrier.size = size;
+	currentCommandBuffer_.pipelineBarrier(
+		vk::PipelineStageFlagBits::eAllCommands, vk::PipelineStageFlagBits::eTransfer, vk::DependencyFlags(), nullptr, srcBarrier, nullptr);
+
+	vk::BufferCopy copyRegion;
+	copyRegion.srcOffset = srcBuf->GetOffset() + offset;
+	copyRegion.dstOffset = 0;
+	copyRegion.size = size;
+	currentCommandBuffer_.copyBuffer(srcBuf->GetBuffer(), buffer->GetBuffer(), copyRegion);
+
+	// make the copied data visible to CPU after the fence is signaled
+	vk::BufferMemoryBarrier dstBarrier;
+	dstBarrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+	dstBarrier.dstAccessMask = vk::AccessFlagBits::eHostRead;
+	dstBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	dstBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	dstBarrier.buffer = buffer->GetBuffer();
+	dstBarrier.offset = 0;
+	dstBarrier.size = VK_WHOLE_SIZE;
+	currentCommandBuffer_.pipelineBarrier(
+		vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eHost, vk::DependencyFlags(), nullptr, dstBarrier, nullptr);
+
+	RegisterReferencedObject(src);
+	RegisterReferencedObject(buffer);
+
+	auto token = new ReadbackTokenVulkan(this, buffer, size, 0);
+	SafeRelease(buffer);
+	return token;
+}
+
 void CommandListVulkan::BeginRenderPass(RenderPass* renderPass)
 {
+	if (isCompute_)
+	{
+		Log(LogType::Error, "BeginRenderPass : RenderPass is not supported in a compute command list.");
+		return;
+	}
+
 	renderPass_ = static_cast<RenderPassVulkan*>(renderPass);
 	if (!renderPass_->GetIsValid())
 	{
@@ -730,8 +939,6 @@ void CommandListVulkan::EndRenderPass()
 
 vk::CommandBuffer CommandListVulkan::GetCommandBuffer() const { return currentCommandBuffer_; }
 
-vk::Fence CommandListVulkan::GetFence() const { return fences_[currentSwapBufferIndex_]; }
-
 void CommandListVulkan::BeginComputePass() {}
 
 void CommandListVulkan::EndComputePass() {}
@@ -746,7 +953,12 @@ void CommandListVulkan::Dispatch(int32_t groupX, int32_t groupY, int32_t groupZ,
 
 	assert(pip_ != nullptr);
 
-	auto pip = static_cast<PipelineStateVulkan*>(pip_);
+	// the pipeline state may be compiled asynchronously
+	auto pip = static_cast<PipelineStateVulkan*>(pip_->GetAvailablePipelineState());
+	if (pip == nullptr)
+	{
+		return;
+	}
 
 	auto& dp = descriptorPools[currentSwapBufferIndex_];
 
@@ -762,8 +974,15 @@ void CommandListVulkan::Dispatch(int32_t groupX, int32_t groupY, int32_t groupZ,
 	std::array<vk::DescriptorBufferInfo, NumConstantBuffer + NumTexture + NumComputeBuffer> descriptorBufferInfos;
 	int descriptorBufferIndex = 0;
 
+	const auto& bindingMasks = pip->GetComputeBindingMasks();
+
 	for (size_t unit_ind = 0; unit_ind < constantBuffers_.size(); unit_ind++)
 	{
+		if ((bindingMasks[0] & (1u << unit_ind)) == 0)
+		{
+			continue;
+		}
+
 		auto cb = static_cast<BufferVulkan*>(constantBuffers_[unit_ind]);
 		if (cb == nullptr)
 		{
@@ -791,6 +1010,9 @@ void CommandListVulkan::Dispatch(int32_t groupX, int32_t groupY, int32_t groupZ,
 	// compute buffer
 	for (int unit_ind = 0; unit_ind < NumComputeBuffer; unit_ind++)
 	{
+		if ((bindingMasks[2] & (1u << unit_ind)) == 0)
+			continue;
+
 		BindingComputeBuffer cb_;
 		GetCurrentComputeBuffer(unit_ind, cb_);
 
@@ -822,16 +1044,22 @@ void CommandListVulkan::Dispatch(int32_t groupX, int32_t groupY, int32_t groupZ,
 		graphics_->GetDevice().updateDescriptorSets(writeDescriptorIndex, writeDescriptorSets.data(), 0, nullptr);
 	}
 
-	std::array<uint32_t, 12> offsets;
+	std::array<uint32_t, NumConstantBuffer + NumComputeBuffer> offsets;
 	offsets.fill(0);
 
-	currentCommandBuffer_.bindDescriptorSets(
-		vk::PipelineBindPoint::eCompute, pip->GetComputePipelineLayout(), 0, 3, descriptorSets.data(), 12, offsets.data());
+	currentCommandBuffer_.bindDescriptorSets(vk::PipelineBindPoint::eCompute,
+											 pip->GetComputePipelineLayout(),
+											 0,
+											 3,
+											 descriptorSets.data(),
+											 static_cast<uint32_t>(offsets.size()),
+											 offsets.data());
 
 	// assign a pipeline
-	if (isPipDirtied)
+	if (isPipDirtied || boundComputePipeline_ != pip->GetComputePipeline())
 	{
 		currentCommandBuffer_.bindPipeline(vk::PipelineBindPoint::eCompute, pip->GetComputePipeline());
+		boundComputePipeline_ = pip->GetComputePipeline();
 	}
 
 	currentCommandBuffer_.dispatch(groupX, groupY, groupZ);
@@ -839,13 +1067,82 @@ void CommandListVulkan::Dispatch(int32_t groupX, int32_t groupY, int32_t groupZ,
 	CommandList::Dispatch(groupX, groupY, groupZ, threadX, threadY, threadZ);
 }
 
-void CommandListVulkan::WaitUntilCompleted()
+void CommandListVulkan::WaitCommandList(CommandList* commandList)
+{
+	auto cl = static_cast<CommandListVulkan*>(commandList);
+	if (cl == nullptr || cl == this)
+	{
+		Log(LogType::Error, "WaitCommandList : commandList is invalid.");
+		return;
+	}
+
+	// commands on the single queue are already executed in order
+	if (!graphics_->IsAsyncComputeEnabled())
+	{
+		return;
+	}
+
+	if (cl->currentSwapBufferIndex_ < 0 || !cl->swapExecuted_[cl->currentSwapBufferIndex_])
+	{
+		Log(LogType::Error, "WaitCommandList : a waited command list must be executed before.");
+		return;
+	}
+
+	WaitTimeline wait;
+	wait.IsCompute = cl->GetIsCompute();
+	wait.Value = cl->swapValues_[cl->currentSwapBufferIndex_];
+	waitTimelines_.push_back(wait);
+}
+
+void CommandListVulkan::MarkAsExecuted(uint64_t value)
 {
 	if (currentSwapBufferIndex_ >= 0)
 	{
-		vk::Result fenceRes =
-			graphics_->GetDevice().waitForFences(fences_[currentSwapBufferIndex_], VK_TRUE, std::numeric_limits<int>::max());
-		if (fenceRes != vk::Result::eSuccess)
+		swapExecuted_[currentSwapBufferIndex_] = true;
+		swapValues_[currentSwapBufferIndex_] = value;
+	}
+
+	waitTimelines_.clear();
+}
+
+bool CommandListVulkan::IsCompleted(int32_t swapIndex, uint64_t beginCount) const
+{
+	// Begin waits the fence before the swap buffer is reused
+	if (swapBeginCounts_[swapIndex] != beginCount)
+	{
+		return true;
+	}
+
+	if (!swapExecuted_[swapIndex])
+	{
+		return false;
+	}
+
+	return graphics_->GetSubmissionQueue(GetIsCompute())->IsCompleted(swapValues_[swapIndex]);
+}
+
+bool CommandListVulkan::WaitUntilCompleted(int32_t swapIndex, uint64_t beginCount)
+{
+	if (swapBeginCounts_[swapIndex] != beginCount)
+	{
+		return true;
+	}
+
+	if (!swapExecuted_[swapIndex])
+	{
+		Log(LogType::Error, "WaitUntilCompleted : CommandList is not executed.");
+		return false;
+	}
+
+	return graphics_->GetSubmissionQueue(GetIsCompute())->Wait(swapValues_[swapIndex]);
+}
+
+void CommandListVulkan::WaitUntilCompleted()
+{
+	if (currentSwapBufferIndex_ >= 0 && swapExecuted_[currentSwapBufferIndex_])
+	{
+		// command lists which are not submitted yet are submitted
+		if (!graphics_->GetSubmissionQueue(GetIsCompute())->Wait(swapValues_[currentSwapBufferIndex_]))
 		{
 			throw "Invalid waitForFences";
 		}
@@ -9,16 +9,29 @@ namespace LLGI
 class DescriptorPoolVulkan
 {
 private:
+	//! sets which are allocated with a layout and reused in the next frames
+	struct SetCache
+	{
+		int32_t offset = 0;
+		std::vector<std::vector<vk::DescriptorSet>> sets;
+	};
+
 	std::shared_ptr<GraphicsVulkan> graphics_;
 	vk::DescriptorPool descriptorPool_ = nullptr;
-	int32_t offset = 0;
-	std::vector<std::vector<vk::DescriptorSet>> cache;
+	std::unordered_map<VkPipelineLayout, SetCache> cache;
+	int32_t allocatedCount_ = 0;
 	int32_t slotSizeMax_;
 	std::vector<vk::DescriptorSet> dummySet_;
 
 	vk::DescriptorPool computeDescriptorPool_ = nullptr;
-	int32_t computeOffset = 0;
-	std::vector<std::vector<vk::DescriptorSet>> computeCache;
+	std::unordered_map<VkPipelineLayout, SetCache> computeCache;
+	int32_t computeAllocatedCount_ = 0;
+
+	const std::vector<vk::DescriptorSet>& Allocate(vk::DescriptorPool pool,
+												   std::unordered_map<VkPipelineLayout, SetCache>& caches,
+												   int32_t& allocatedCount,
+												   vk::PipelineLayout pipelineLayout,
+												   const std::array<vk::DescriptorSetLayout, 3>& layouts);
 
 public:
 	DescriptorPoolVulkan(std::shared_ptr<GraphicsVulkan> graphics, int32_t slot_size_max, int32_t constant_size, int32_t texture_size, int32_t storage_size);
@@ -35,13 +48,34 @@ struct PlatformContextVulkan
 
 class CommandListVulkan : public CommandList
 {
+public:
+	struct WaitTimeline
+	{
+		bool IsCompute = false;
+		uint64_t Value = 0;
+	};
+
 private:
 	std::shared_ptr<GraphicsVulkan> graphics_;
+	vk::CommandPool commandPool_;
+	bool isCompute_ = false;
+
+	//! values are captured in WaitCommandList because a waited command list may be begun again before this one is executed
+	std::vector<WaitTimeline> waitTimelines_;
 	vk::CommandBuffer currentCommandBuffer_;
+
+	//! a pipeline state may be replaced with a fallback while it is compiled
+	vk::Pipeline boundPipeline_;
+	vk::Pipeline boundComputePipeline_;
 	std::vector<vk::CommandBuffer> commandBuffers_;
 	std::vector<std::shared_ptr<DescriptorPoolVulkan>> descriptorPools;
 	int32_t currentSwapBufferIndex_;
-	std::vector<vk::Fence> fences_;
+	uint64_t beginCount_ = 0;
+	std::vector<uint64_t> swapBeginCounts_;
+	std::vector<bool> swapExecuted_;
+
+	//! values of the submission queue which are reached when command buffers are finished
+	std::vector<uint64_t> swapValues_;
 	vk::Sampler samplers_[2][2];
 
 	RenderPassVulkan* renderPass_ = nullptr;
@@ -51,7 +85,10 @@ public:
 	CommandListVulkan();
 	~CommandListVulkan() override;
 
-	bool Initialize(GraphicsVulkan* graphics, int32_t drawingCount);
+	/**
+		@param	isCompute	whether it is executed on the compute queue if the queue is available
+	*/
+	bool Initialize(GraphicsVulkan* graphics, int32_t drawingCount, bool isCompute = false);
 
 	void Begin() override;
 	void End() override;
@@ -73,16 +110,50 @@ public:
 
 	void CopyBuffer(Buffer* src, Buffer* dst) override;
 
+	void WaitCommandList(CommandList* commandList) override;
+
+	ReadbackToken* ReadbackTexture(Texture* src, const Vec2I& position, const Vec2I& size) override;
+
+	ReadbackToken* ReadbackBuffer(Buffer* src, int32_t offset, int32_t size) override;
+
 	void BeginRenderPass(RenderPass* renderPass) override;
 	void EndRenderPass() override;
 	vk::CommandBuffer GetCommandBuffer() const;
-	vk::Fence GetFence() const;
 
 	void BeginComputePass() override;
 	void EndComputePass() override;
 	void Dispatch(int32_t groupX, int32_t groupY, int32_t groupZ, int32_t threadX, int32_t threadY, int32_t threadZ) override;
 
 	void WaitUntilCompleted() override;
+
+	int32_t GetCurrentSwapBufferIndex() const { return currentSwapBufferIndex_; }
+	uint64_t GetBeginCount() const { return beginCount_; }
+
+	/**
+		@brief	whether it is executed on the compute queue
+	*/
+	bool GetIsCompute() const { return isCompute_ && graphics_->IsAsyncComputeEnabled(); }
+
+	/**
+		@brief	get values of timelines which must be reached before the current command buffer is executed
+	*/
+	const std::vector<WaitTimeline>& GetWaitTimelines() const { return waitTimelines_; }
+
+	/**
+		@brief	called by Graphics when the current command buffer is added into the submission queue
+		@param	value	a value of the submission queue which is reached when the command buffer is finished
+	*/
+	void MarkAsExecuted(uint64_t value);
+
+	/**
+		@brief	whether commands which were recorded between specified Begin and End are completed. It doesn't block.
+	*/
+	bool IsCompleted(int32_t swapIndex, uint64_t beginCount) const;
+
+	/**
+		@brief	wait until commands which were recorded between specified Begin and End are completed.
+	*/
+	bool WaitUntilCompleted(int32_t swapIndex, uint64_t beginCount);
 };
 
 } // namespace LLGI
@@ -1,5 +1,11 @@
 
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 #include <memory>
+#include <sstream>
+#include <thread>
 
 #if defined(ENABLE_VULKAN_COMPILER)
 
@@ -18,29 +24,236 @@
 namespace LLGI
 {
 
-#if defined(ENABLE_VULKAN_COMPILER)
+namespace
+{
 
-#endif
+const char CacheFileMagic[4] = {'L', 'L', 'S', 'C'};
+
+//! increase it when options of the compiler are changed
+const uint32_t CacheFileVersion = 1;
+
+void HashFNV1a(uint64_t& hash, const void* data, size_t size)
+{
+	const auto bytes = static_cast<const uint8_t*>(data);
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ULL;
+	}
+}
+
+//! glslang is initialized for the process, so it is shared by all compilers
+std::mutex processMutex;
+int32_t processReferenceCount = 0;
+
+} // namespace
 
 CompilerVulkan::CompilerVulkan()
 {
 #if defined(ENABLE_VULKAN_COMPILER)
-	glslang::InitializeProcess();
+	std::lock_guard<std::mutex> lock(processMutex);
+	if (processReferenceCount == 0)
+	{
+		glslang::InitializeProcess();
+	}
+	processReferenceCount++;
 #endif
 }
 
 CompilerVulkan::~CompilerVulkan()
 {
+	// tasks must be finished before glslang is finalized
+	workerPool_.reset();
+
 #if defined(ENABLE_VULKAN_COMPILER)
-	glslang::FinalizeProcess();
+	std::lock_guard<std::mutex> lock(processMutex);
+	processReferenceCount--;
+	if (processReferenceCount == 0)
+	{
+		glslang::FinalizeProcess();
+	}
 #endif
 }
 
 void CompilerVulkan::Initialize() {}
 
+std::string CompilerVulkan::GetCachePath(const char* code, ShaderStageType shaderStage) const
+{
+	uint64_t hash = 14695981039346656037ULL;
+	HashFNV1a(hash, &CacheFileVersion, sizeof(CacheFileVersion));
+
+#if defined(ENABLE_VULKAN_COMPILER)
+	// it contains a version of glslang
+	const auto compilerVersion = glslang::GetGlslVersionString();
+	HashFNV1a(hash, compilerVersion, strlen(compilerVersion));
+#endif
+
+	const auto stage = static_cast<int32_t>(shaderStage);
+	HashFNV1a(hash, &stage, sizeof(stage));
+	HashFNV1a(hash, code, strlen(code));
+
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx.spv", static_cast<unsigned long long>(hash));
+
+	auto path = cacheDirectory_;
+	if (path.back() != '/' && path.back() != '\\')
+	{
+		path += '/';
+	}
+
+	return path + name;
+}
+
+bool CompilerVulkan::LoadCache(CompilerResult& result, const std::string& path, const char* code, ShaderStageType shaderStage) const
+{
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
+	if (!file)
+	{
+		return false;
+	}
+
+	const auto fileSize = static_cast<uint64_t>(file.tellg());
+	file.seekg(0, std::ios::beg);
+
+	char magic[4];
+	uint32_t version = 0;
+	int32_t stage = 0;
+	uint64_t codeSize = 0;
+	uint64_t binarySize = 0;
+	file.read(magic, sizeof(magic));
+	file.read(reinterpret_cast<char*>(&version), sizeof(version));
+	file.read(reinterpret_cast<char*>(&stage), sizeof(stage));
+	file.read(reinterpret_cast<char*>(&codeSize), sizeof(codeSize));
+	file.read(reinterpret_cast<char*>(&binarySize), sizeof(binarySize));
+
+	// the size of code is compared to detect collisions of hashes
+	if (!file || memcmp(magic, CacheFileMagic, sizeof(magic)) != 0 || version != CacheFileVersion ||
+		stage != static_cast<int32_t>(shaderStage) || codeSize != strlen(code) || binarySize == 0)
+	{
+		return false;
+	}
+
+	// a broken size must not allocate more than the file, so it is compiled again
+	if (binarySize != fileSize - static_cast<uint64_t>(file.tellg()))
+	{
+		Log(LogType::Warning, std::string("A shader cache is broken : ") + path);
+		return false;
+	}
+
+	std::vector<uint8_t> binary(static_cast<size_t>(binarySize));
+	if (!file.read(reinterpret_cast<char*>(binary.data()), binary.size()))
+	{
+		Log(LogType::Warning, std::string("A shader cache is broken : ") + path);
+		return false;
+	}
+
+	result.Binary.resize(1);
+	result.Binary[0] = std::move(binary);
+	return true;
+}
+
+void CompilerVulkan::SaveCache(const CompilerResult& result, const std::string& path, const char* code, ShaderStageType shaderStage) const
+{
+	// write another file and rename it not to read a file which is being written by another thread or process
+	std::ostringstream tempPathStream;
+	tempPathStream << path << "." << std::this_thread::get_id() << ".tmp";
+	const auto tempPath = tempPathStream.str();
+
+	{
+		std::ofstream file(tempPath, std::ios::binary);
+		if (!file)
+		{
+			Log(LogType::Warning, std::string("Failed to open a file to save a shader cache : ") + tempPath);
+			return;
+		}
+
+		const auto stage = static_cast<int32_t>(shaderStage);
+		const auto codeSize = static_cast<uint64_t>(strlen(code));
+		const auto binarySize = static_cast<uint64_t>(result.Binary[0].size());
+		file.write(CacheFileMagic, sizeof(CacheFileMagic));
+		file.write(reinterpret_cast<const char*>(&CacheFileVersion), sizeof(CacheFileVersion));
+		file.write(reinterpret_cast<const char*>(&stage), sizeof(stage));
+		file.write(reinterpret_cast<const char*>(&codeSize), sizeof(codeSize));
+		file.write(reinterpret_cast<const char*>(&binarySize), sizeof(binarySize));
+		file.write(reinterpret_cast<const char*>(result.Binary[0].data()), result.Binary[0].size());
+
+		if (!file)
+		{
+			Log(LogType::Warning, std::string("Failed to save a shader cache : ") + tempPath);
+			file.close();
+			remove(tempPath.c_str());
+			return;
+		}
+	}
+
+	// rename fails on some platforms if the file exists
+	if (rename(tempPath.c_str(), path.c_str()) != 0)
+	{
+		remove(path.c_str());
+		if (rename(tempPath.c_str(), path.c_str()) != 0)
+		{
+			remove(tempPath.c_str());
+		}
+	}
+}
+
+void CompilerVulkan::CompileBatch(std::vector<CompilerResult>& results, const std::vector<CompilerInput>& inputs)
+{
+	results.clear();
+	results.resize(inputs.size());
+
+	if (inputs.size() <= 1)
+	{
+		Compiler::CompileBatch(results, inputs);
+		return;
+	}
+
+	WorkerPool* workerPool = nullptr;
+
+	{
+		std::lock_guard<std::mutex> lock(workerPoolMutex_);
+		if (workerPool_ == nullptr)
+		{
+			workerPool_.reset(new WorkerPool());
+		}
+		workerPool = workerPool_.get();
+	}
+
+	std::mutex mutex;
+	std::condition_variable condition;
+	size_t finishedCount = 0;
+
+	for (size_t i = 0; i < inputs.size(); i++)
+	{
+		workerPool->Enqueue([&, i]() {
+			Compile(results[i], inputs[i].Code, inputs[i].ShaderStage);
+
+			std::lock_guard<std::mutex> lock(mutex);
+			finishedCount++;
+			condition.notify_one();
+		});
+	}
+
+	std::unique_lock<std::mutex> lock(mutex);
+	condition.wait(lock, [&]() { return finishedCount == inputs.size(); });
+}
+
+void CompilerVulkan::SetCacheDirectory(const char* directory) { cacheDirectory_ = directory != nullptr ? directory : ""; }
+
 void CompilerVulkan::Compile(CompilerResult& result, const char* code, ShaderStageType shaderStage)
 {
 #if defined(ENABLE_VULKAN_COMPILER)
+	std::string cachePath;
+	if (!cacheDirectory_.empty())
+	{
+		cachePath = GetCachePath(code, shaderStage);
+
+		if (LoadCache(result, cachePath, code, shaderStage))
+		{
+			return;
+		}
+	}
+
 	EShLanguage stage;
 	switch (shaderStage)
 	{
@@ -107,6 +320,11 @@ void CompilerVulkan::Compile(CompilerResult& result, const char* code, ShaderSta
 	result.Binary.resize(1);
 	result.Binary[0].resize(spirvCode.size() * sizeof(unsigned int));
 	memcpy(result.Binary[0].data(), spirvCode.data(), result.Binary[0].size());
+
+	if (!cachePath.empty())
+	{
+		SaveCache(result, cachePath, code, shaderStage);
+	}
 #endif
 }
 
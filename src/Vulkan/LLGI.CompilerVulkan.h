@@ -2,14 +2,31 @@
 #pragma once
 
 #include "../LLGI.Compiler.h"
+#include "../Utils/LLGI.WorkerPool.h"
 #include "LLGI.BaseVulkan.h"
+#include <mutex>
 
 namespace LLGI
 {
 
+/**
+	@brief	a compiler from GLSL to SPIR-V
+	@note
+	Compile can be called from multiple threads concurrently. glslang is initialized once while any compiler is alive.
+*/
 class CompilerVulkan : public Compiler
 {
 private:
+	std::string cacheDirectory_;
+
+	//! created when a batch is compiled first
+	std::unique_ptr<WorkerPool> workerPool_;
+	std::mutex workerPoolMutex_;
+
+	std::string GetCachePath(const char* code, ShaderStageType shaderStage) const;
+	bool LoadCache(CompilerResult& result, const std::string& path, const char* code, ShaderStageType shaderStage) const;
+	void SaveCache(const CompilerResult& result, const std::string& path, const char* code, ShaderStageType shaderStage) const;
+
 public:
 	CompilerVulkan();
 	~CompilerVulkan() override;
@@ -17,6 +34,15 @@ public:
 	void Initialize() override;
 	void Compile(CompilerResult& result, const char* code, ShaderStageType shaderStage) override;
 
+	void CompileBatch(std::vector<CompilerResult>& results, const std::vector<CompilerInput>& inputs) override;
+
+	/**
+		@note
+		A file name is a hash of code, a stage and a version of the compiler. Messages are not stored.
+		It must not be called while codes are compiled.
+	*/
+	void SetCacheDirectory(const char* directory) override;
+
 	DeviceType GetDeviceType() const override { return DeviceType::Vulkan; }
 };
 
@@ -3,8 +3,10 @@
 #include "LLGI.BufferVulkan.h"
 #include "LLGI.CommandListVulkan.h"
 #include "LLGI.PipelineStateVulkan.h"
+#include "LLGI.ReadbackVulkan.h"
 #include "LLGI.ShaderVulkan.h"
 #include "LLGI.SingleFrameMemoryPoolVulkan.h"
+#include "LLGI.SubmissionQueueVulkan.h"
 #include "LLGI.TextureVulkan.h"
 
 namespace LLGI
@@ -12,22 +14,34 @@ namespace LLGI
 
 GraphicsVulkan::GraphicsVulkan(const vk::Device& device,
 							   const vk::Queue& quque,
-							   const vk::CommandPool& commandPool,
+							   uint32_t queueFamilyIndex,
 							   const vk::PhysicalDevice& pysicalDevice,
 							   int32_t swapBufferCount,
-							   std::function<void(vk::CommandBuffer, vk::Fence)> addCommand,
+							   SubmissionQueueVulkan* submissionQueue,
 							   RenderPassPipelineStateCacheVulkan* renderPassPipelineStateCache,
+							   PipelineStateCacheVulkan* pipelineStateCache,
 							   ReferenceObject* owner)
 	: vkDevice_(device)
 	, vkQueue_(quque)
-	, vkCmdPool_(commandPool)
 	, vkPysicalDevice_(pysicalDevice)
-	, addCommand_(addCommand)
+	, submissionQueue_(submissionQueue)
 	, renderPassPipelineStateCache_(renderPassPipelineStateCache)
+	, pipelineStateCache_(pipelineStateCache)
 	, owner_(owner)
 {
 	SafeAddRef(owner_);
 
+	queueFamilyIndex_ = queueFamilyIndex;
+	transferQueueFamilyIndex_ = queueFamilyIndex;
+	vkCmdPool_ = CreateCommandPool(queueFamilyIndex_, vk::CommandPoolCreateFlagBits::eResetCommandBuffer);
+
+	SafeAddRef(submissionQueue_);
+	if (submissionQueue_ == nullptr)
+	{
+		submissionQueue_ = new SubmissionQueueVulkan();
+		submissionQueue_->Initialize(vkDevice_, vkQueue_, false);
+	}
+
 	swapBufferCount_ = swapBufferCount;
 
 	SafeAddRef(renderPassPipelineStateCache_);
@@ -35,10 +49,40 @@ GraphicsVulkan::GraphicsVulkan(const vk::Device& device,
 	{
 		renderPassPipelineStateCache_ = new RenderPassPipelineStateCacheVulkan(device, nullptr);
 	}
+
+	SafeAddRef(pipelineStateCache_);
+	if (pipelineStateCache_ == nullptr)
+	{
+		pipelineStateCache_ = new PipelineStateCacheVulkan(device);
+	}
+
+	readbackBufferPool_.reset(new ReadbackBufferPoolVulkan(this));
 }
 
 GraphicsVulkan::~GraphicsVulkan()
 {
+	// command pools are destroyed with this graphics
+	WaitFinish();
+
+	CollectInitialLayoutBatches(true);
+	CollectTransferBatches(true);
+
+	// command buffers which are allocated from pools are freed with them
+	for (auto pool : {vkCmdPool_, transferCmdPool_, computeCmdPool_})
+	{
+		if (pool)
+		{
+			vkDevice_.destroyCommandPool(pool);
+		}
+	}
+
+	SafeRelease(transferSubmissionQueue_);
+	SafeRelease(computeSubmissionQueue_);
+	SafeRelease(submissionQueue_);
+
+	readbackBufferPool_.reset();
+
+	SafeRelease(pipelineStateCache_);
 	SafeRelease(renderPassPipelineStateCache_);
 
 	SafeRelease(owner_);
@@ -50,10 +94,56 @@ void GraphicsVulkan::Execute(CommandList* commandList)
 {
 	auto commandList_ = static_cast<CommandListVulkan*>(commandList);
 	auto cmdBuf = commandList_->GetCommandBuffer();
-	addCommand_(cmdBuf, commandList_->GetFence());
+
+	// textures created since the last submission must leave the undefined layout before the command list runs
+	FlushInitialLayoutTransitions();
+
+	std::vector<SubmissionQueueVulkan::SemaphoreOperation> waits;
+	for (const auto& wait : commandList_->GetWaitTimelines())
+	{
+		SubmissionQueueVulkan::SemaphoreOperation op;
+		op.Semaphore = GetSubmissionQueue(wait.IsCompute)->GetTimeline();
+		op.Value = wait.Value;
+		waits.push_back(op);
+	}
+
+	if (commandList_->GetIsCompute())
+	{
+		// the compute queue may wait command lists which are not submitted yet on the graphics queue
+		submissionQueue_->Flush();
+
+		computeSubmittedValue_ = computeSubmissionQueue_->Add(cmdBuf, waits);
+		computeSubmissionQueue_->Flush();
+		commandList_->MarkAsExecuted(computeSubmittedValue_);
+		return;
+	}
+
+	// submitted together at the end of the frame
+	submittedValue_ = submissionQueue_->Add(cmdBuf, waits);
+	commandList_->MarkAsExecuted(submittedValue_);
 }
 
-void GraphicsVulkan::WaitFinish() { vkQueue_.waitIdle(); }
+void GraphicsVulkan::Flush() { submissionQueue_->Flush(); }
+
+void GraphicsVulkan::WaitFinish()
+{
+	// queues may be shared with other graphics, so only commands which are added by this graphics are waited
+	if (isTransferQueueEnabled_)
+	{
+		std::lock_guard<std::mutex> lock(initialLayoutMutex_);
+		for (const auto& batch : transferBatches_)
+		{
+			transferSubmissionQueue_->Wait(batch.value);
+		}
+	}
+
+	if (isAsyncComputeEnabled_)
+	{
+		computeSubmissionQueue_->Wait(computeSubmittedValue_);
+	}
+
+	submissionQueue_->Wait(submittedValue_);
+}
 
 Buffer* GraphicsVulkan::CreateBuffer(BufferUsageType usage, int32_t size)
 {
@@ -92,6 +182,53 @@ PipelineState* GraphicsVulkan::CreatePiplineState()
 	return nullptr;
 }
 
+int32_t GraphicsVulkan::PrewarmPipelines(const char* manifestPath, Shader** shaders, int32_t shaderCount)
+{
+	std::vector<std::string> keys;
+	if (!PipelineStateCacheVulkan::LoadManifest(manifestPath, keys))
+	{
+		return 0;
+	}
+
+	std::unordered_map<uint64_t, Shader*> shaderMap;
+	for (int32_t i = 0; i < shaderCount; i++)
+	{
+		if (shaders[i] != nullptr)
+		{
+			shaderMap[static_cast<ShaderVulkan*>(shaders[i])->GetHash()] = shaders[i];
+		}
+	}
+
+	std::vector<PipelineStateVulkan*> pipelineStates;
+	for (const auto& key : keys)
+	{
+		auto pipelineState = new PipelineStateVulkan();
+		if (!pipelineState->Initialize(this) || !pipelineState->RestoreFromPipelineKey(key, shaderMap))
+		{
+			pipelineState->Release();
+			continue;
+		}
+
+		// pipelines are kept alive after the pipeline states are released
+		pipelineStateCache_->Pin(key);
+		pipelineState->CompileAsync();
+		pipelineStates.push_back(pipelineState);
+	}
+
+	int32_t count = 0;
+	for (auto pipelineState : pipelineStates)
+	{
+		if (pipelineState->WaitUntilReady())
+		{
+			count++;
+		}
+
+		pipelineState->Release();
+	}
+
+	return count;
+}
+
 SingleFrameMemoryPool* GraphicsVulkan::CreateSingleFrameMemoryPool(int32_t constantBufferPoolSize, int32_t drawingCount)
 {
 	return new SingleFrameMemoryPoolVulkan(this, true, swapBufferCount_, constantBufferPoolSize, drawingCount);
@@ -110,6 +247,19 @@ CommandList* GraphicsVulkan::CreateCommandList(SingleFrameMemoryPool* memoryPool
 	return nullptr;
 }
 
+CommandList* GraphicsVulkan::CreateComputeCommandList(SingleFrameMemoryPool* memoryPool)
+{
+	auto mp = static_cast<SingleFrameMemoryPoolVulkan*>(memoryPool);
+
+	auto commandList = new CommandListVulkan();
+	if (commandList->Initialize(this, mp->GetDrawingCount(), true))
+	{
+		return commandList;
+	}
+	SafeRelease(commandList);
+	return nullptr;
+}
+
 RenderPass* GraphicsVulkan::CreateRenderPass(Texture** textures, int32_t textureCount, Texture* depthTexture)
 {
 	assert(textures != nullptr);
@@ -226,8 +376,9 @@ std::vector<uint8_t> GraphicsVulkan::CaptureRenderTarget(Texture* renderTarget)
 	}
 
 	std::vector<uint8_t> result;
-	VkDevice device = static_cast<VkDevice>(GetDevice());
-	vkDeviceWaitIdle(device);
+
+	// a device is not waited because queues may be used by other graphics on other threads
+	WaitFinish();
 
 	auto texture = static_cast<TextureVulkan*>(renderTarget);
 	auto width = texture->GetSizeAs2D().X;
@@ -323,6 +474,7 @@ std::vector<uint8_t> GraphicsVulkan::CaptureRenderTarget(Texture* renderTarget)
 
 	// Blit
 	{
+		VkDevice device = static_cast<VkDevice>(vkDevice_);
 		void* rawData = nullptr;
 		vkMapMemory(device, destBuffer.GetNativeBufferMemory(), 0, destBuffer.GetSize(), 0, &rawData);
 		result.resize(static_cast<size_t>(destBuffer.GetSize()));
@@ -357,6 +509,314 @@ uint32_t GraphicsVulkan::GetMemoryTypeIndex(uint32_t bits, const vk::MemoryPrope
 	return LLGI::GetMemoryTypeIndex(vkPysicalDevice_, bits, properties);
 }
 
+vk::CommandPool GraphicsVulkan::CreateCommandPool(uint32_t queueFamilyIndex, vk::CommandPoolCreateFlags flags)
+{
+	vk::CommandPoolCreateInfo cmdPoolInfo;
+	cmdPoolInfo.queueFamilyIndex = queueFamilyIndex;
+	cmdPoolInfo.flags = flags;
+	return vkDevice_.createCommandPool(cmdPoolInfo);
+}
+
+void GraphicsVulkan::SetTransferQueue(SubmissionQueueVulkan* queue, uint32_t transferQueueFamilyIndex)
+{
+	std::lock_guard<std::mutex> lock(initialLayoutMutex_);
+
+	// a single queue device (or a queue in the same family) doesn't need ownership transfers
+	if (queue == nullptr || transferQueueFamilyIndex == queueFamilyIndex_ || isTransferQueueEnabled_)
+	{
+		return;
+	}
+
+	SafeAssign(transferSubmissionQueue_, queue);
+	transferQueueFamilyIndex_ = transferQueueFamilyIndex;
+	transferCmdPool_ = CreateCommandPool(transferQueueFamilyIndex_, vk::CommandPoolCreateFlagBits::eTransient);
+	isTransferQueueEnabled_ = true;
+}
+
+void GraphicsVulkan::SetComputeQueue(SubmissionQueueVulkan* queue, uint32_t computeQueueFamilyIndex)
+{
+	if (queue == nullptr || computeQueueFamilyIndex == queueFamilyIndex_ || isAsyncComputeEnabled_)
+	{
+		return;
+	}
+
+	// dependencies between queues are expressed with timelines
+	if (!submissionQueue_->GetTimeline() || !queue->GetTimeline())
+	{
+		return;
+	}
+
+	SafeAssign(computeSubmissionQueue_, queue);
+	computeQueueFamilyIndex_ = computeQueueFamilyIndex;
+	computeCmdPool_ = CreateCommandPool(computeQueueFamilyIndex_, vk::CommandPoolCreateFlagBits::eResetCommandBuffer);
+	isAsyncComputeEnabled_ = true;
+}
+
+std::vector<uint32_t> GraphicsVulkan::GetConcurrentQueueFamilyIndices() const
+{
+	if (!isAsyncComputeEnabled_)
+	{
+		return {};
+	}
+
+	return {queueFamilyIndex_, computeQueueFamilyIndex_};
+}
+
+void GraphicsVulkan::CollectTransferBatches(bool waitAll)
+{
+	for (auto it = transferBatches_.begin(); it != transferBatches_.end();)
+	{
+		if (waitAll)
+		{
+			if (!transferSubmissionQueue_->Wait(it->value))
+			{
+				Log(LogType::Error, "Failed to wait an upload on the transfer queue.");
+			}
+		}
+		else if (!it->isAcquireRecorded || !transferSubmissionQueue_->IsCompleted(it->value))
+		{
+			it++;
+			continue;
+		}
+
+		vkDevice_.freeCommandBuffers(transferCmdPool_, it->commandBuffer);
+
+		// a semaphore which is not waited by the graphics queue is still owned by the batch
+		if (it->semaphore)
+		{
+			vkDevice_.destroySemaphore(it->semaphore);
+		}
+
+		it = transferBatches_.erase(it);
+	}
+}
+
+void GraphicsVulkan::CollectInitialLayoutBatches(bool waitAll)
+{
+	for (auto it = initialLayoutBatches_.begin(); it != initialLayoutBatches_.end();)
+	{
+		if (waitAll)
+		{
+			if (!submissionQueue_->Wait(it->value))
+			{
+				Log(LogType::Error, "Failed to wait an initial layout transition.");
+			}
+		}
+		else if (!submissionQueue_->IsCompleted(it->value))
+		{
+			it++;
+			continue;
+		}
+
+		vkDevice_.freeCommandBuffers(vkCmdPool_, it->commandBuffer);
+
+		for (auto semaphore : it->waitSemaphores)
+		{
+			vkDevice_.destroySemaphore(semaphore);
+		}
+
+		it = initialLayoutBatches_.erase(it);
+	}
+}
+
+void GraphicsVulkan::RegisterInitialLayoutTransition(TextureVulkan* texture)
+{
+	std::lock_guard<std::mutex> lock(initialLayoutMutex_);
+	pendingInitialLayoutTextures_.push_back(texture);
+}
+
+void GraphicsVulkan::UnregisterInitialLayoutTransition(TextureVulkan* texture)
+{
+	std::lock_guard<std::mutex> lock(initialLayoutMutex_);
+
+	auto it = std::find(pendingInitialLayoutTextures_.begin(), pendingInitialLayoutTextures_.end(), texture);
+	if (it != pendingInitialLayoutTextures_.end())
+	{
+		pendingInitialLayoutTextures_.erase(it);
+		return;
+	}
+
+	for (auto& batch : transferBatches_)
+	{
+		if (batch.texture != texture)
+		{
+			continue;
+		}
+
+		// the image must not be destroyed while it is copied
+		if (!transferSubmissionQueue_->Wait(batch.value))
+		{
+			Log(LogType::Error, "Failed to wait an upload on the transfer queue.");
+		}
+
+		batch.texture = nullptr;
+		batch.isAcquireRecorded = true;
+	}
+
+	for (auto& batch : initialLayoutBatches_)
+	{
+		if (std::find(batch.textures.begin(), batch.textures.end(), texture) == batch.textures.end())
+		{
+			continue;
+		}
+
+		// the image must not be destroyed while the barrier is executed
+		if (!submissionQueue_->Wait(batch.value))
+		{
+			Log(LogType::Error, "Failed to wait an initial layout transition.");
+		}
+		break;
+	}
+}
+
+bool GraphicsVulkan::TakeInitialLayoutTransition(TextureVulkan* texture)
+{
+	std::lock_guard<std::mutex> lock(initialLayoutMutex_);
+
+	auto it = std::find(pendingInitialLayoutTextures_.begin(), pendingInitialLayoutTextures_.end(), texture);
+	if (it == pendingInitialLayoutTextures_.end())
+	{
+		return false;
+	}
+
+	pendingInitialLayoutTextures_.erase(it);
+	return true;
+}
+
+bool GraphicsVulkan::FlushInitialLayoutTransitions()
+{
+	std::lock_guard<std::mutex> lock(initialLayoutMutex_);
+
+	CollectInitialLayoutBatches(false);
+	CollectTransferBatches(false);
+
+	const auto hasAcquire =
+		std::any_of(transferBatches_.begin(), transferBatches_.end(), [](const TransferBatch& b) { return !b.isAcquireRecorded; });
+
+	if (pendingInitialLayoutTextures_.empty() && !hasAcquire)
+	{
+		return true;
+	}
+
+	InitialLayoutBatch batch;
+
+	vk::CommandBufferAllocateInfo cmdBufInfo;
+	cmdBufInfo.commandPool = vkCmdPool_;
+	cmdBufInfo.level = vk::CommandBufferLevel::ePrimary;
+	cmdBufInfo.commandBufferCount = 1;
+	batch.commandBuffer = vkDevice_.allocateCommandBuffers(cmdBufInfo)[0];
+
+	vk::CommandBufferBeginInfo cmdBufferBeginInfo;
+	cmdBufferBeginInfo.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit;
+	batch.commandBuffer.begin(cmdBufferBeginInfo);
+
+	for (auto texture : pendingInitialLayoutTextures_)
+	{
+		texture->RecordInitialLayoutTransition(batch.commandBuffer);
+	}
+
+	std::vector<SubmissionQueueVulkan::SemaphoreOperation> waits;
+
+	for (auto& transferBatch : transferBatches_)
+	{
+		if (transferBatch.isAcquireRecorded)
+		{
+			continue;
+		}
+
+		transferBatch.texture->RecordTransferAcquire(batch.commandBuffer);
+		batch.waitSemaphores.push_back(transferBatch.semaphore);
+
+		SubmissionQueueVulkan::SemaphoreOperation wait;
+		wait.Semaphore = transferBatch.semaphore;
+		waits.push_back(wait);
+	}
+
+	batch.commandBuffer.end();
+
+	// it is submitted with command lists which are executed after it
+	batch.value = submissionQueue_->Add(batch.commandBuffer, waits);
+	submittedValue_ = batch.value;
+	batch.textures.swap(pendingInitialLayoutTextures_);
+
+	// semaphores are destroyed with the batch which waits them
+	for (auto& transferBatch : transferBatches_)
+	{
+		if (transferBatch.isAcquireRecorded)
+		{
+			continue;
+		}
+
+		batch.textures.push_back(transferBatch.texture);
+		transferBatch.semaphore = nullptr;
+		transferBatch.isAcquireRecorded = true;
+	}
+
+	initialLayoutBatches_.push_back(std::move(batch));
+	return true;
+}
+
+vk::CommandBuffer GraphicsVulkan::BeginTransferCommands()
+{
+	std::lock_guard<std::mutex> lock(initialLayoutMutex_);
+
+	vk::CommandBufferAllocateInfo cmdBufInfo;
+	cmdBufInfo.commandPool = transferCmdPool_;
+	cmdBufInfo.level = vk::CommandBufferLevel::ePrimary;
+	cmdBufInfo.commandBufferCount = 1;
+	auto commandBuffer = vkDevice_.allocateCommandBuffers(cmdBufInfo)[0];
+
+	vk::CommandBufferBeginInfo cmdBufferBeginInfo;
+	cmdBufferBeginInfo.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit;
+	commandBuffer.begin(cmdBufferBeginInfo);
+
+	return commandBuffer;
+}
+
+bool GraphicsVulkan::SubmitTransferCommands(vk::CommandBuffer commandBuffer, TextureVulkan* texture)
+{
+	std::lock_guard<std::mutex> lock(initialLayoutMutex_);
+
+	TransferBatch batch;
+	batch.commandBuffer = commandBuffer;
+	batch.semaphore = vkDevice_.createSemaphore(vk::SemaphoreCreateInfo());
+	batch.texture = texture;
+
+	SubmissionQueueVulkan::SemaphoreOperation signal;
+	signal.Semaphore = batch.semaphore;
+
+	// a binary semaphore must be signaled by a submission before it is waited, so it is submitted immediately
+	batch.value = transferSubmissionQueue_->Add(batch.commandBuffer, {}, {signal});
+	if (!transferSubmissionQueue_->Flush())
+	{
+		Log(LogType::Error, "Failed to submit an upload on the transfer queue.");
+		vkDevice_.freeCommandBuffers(transferCmdPool_, batch.commandBuffer);
+		vkDevice_.destroySemaphore(batch.semaphore);
+		return false;
+	}
+
+	transferBatches_.push_back(batch);
+	return true;
+}
+
+void GraphicsVulkan::WaitTransfer(TextureVulkan* texture)
+{
+	std::lock_guard<std::mutex> lock(initialLayoutMutex_);
+
+	for (auto& batch : transferBatches_)
+	{
+		if (batch.texture != texture)
+		{
+			continue;
+		}
+
+		if (!transferSubmissionQueue_->Wait(batch.value))
+		{
+			Log(LogType::Error, "Failed to wait an upload on the transfer queue.");
+		}
+	}
+}
+
 VkCommandBuffer GraphicsVulkan::BeginSingleTimeCommands()
 {
 	VkCommandBufferAllocateInfo allocInfo = {};
@@ -374,6 +834,9 @@ VkCommandBuffer GraphicsVulkan::BeginSingleTimeCommands()
 
 	vkBeginCommandBuffer(commandBuffer, &beginInfo);
 
+	// transitions are added into the queue before the command buffer
+	FlushInitialLayoutTransitions();
+
 	return commandBuffer;
 }
 
@@ -381,13 +844,12 @@ bool GraphicsVulkan::EndSingleTimeCommands(VkCommandBuffer commandBuffer)
 {
 	vkEndCommandBuffer(commandBuffer);
 
-	VkSubmitInfo submitInfo = {};
-	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-	submitInfo.commandBufferCount = 1;
-	submitInfo.pCommandBuffers = &commandBuffer;
-
-	LLGI_VK_CHECK(vkQueueSubmit(static_cast<VkQueue>(vkQueue_), 1, &submitInfo, VK_NULL_HANDLE));
-	LLGI_VK_CHECK(vkQueueWaitIdle(static_cast<VkQueue>(vkQueue_)));
+	// command lists which are executed before must be submitted before
+	const auto value = submissionQueue_->Add(static_cast<vk::CommandBuffer>(commandBuffer));
+	if (!submissionQueue_->Wait(value))
+	{
+		return false;
+	}
 
 	vkFreeCommandBuffers(static_cast<VkDevice>(GetDevice()), static_cast<VkCommandPool>(GetCommandPool()), 1, &commandBuffer);
 
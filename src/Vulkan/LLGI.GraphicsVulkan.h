@@ -2,9 +2,11 @@
 
 #include "../LLGI.Graphics.h"
 #include "LLGI.BaseVulkan.h"
+#include "LLGI.PipelineStateCacheVulkan.h"
 #include "LLGI.RenderPassPipelineStateCacheVulkan.h"
 #include "LLGI.RenderPassVulkan.h"
-#include <functional>
+#include <algorithm>
+#include <mutex>
 #include <unordered_map>
 
 namespace LLGI
@@ -13,6 +15,8 @@ namespace LLGI
 class RenderPassVulkan;
 class RenderPassPipelineStateVulkan;
 class TextureVulkan;
+class ReadbackBufferPoolVulkan;
+class SubmissionQueueVulkan;
 
 class GraphicsVulkan : public Graphics
 {
@@ -21,21 +25,75 @@ private:
 
 	vk::Device vkDevice_;
 	vk::Queue vkQueue_;
-	vk::CommandPool vkCmdPool_;
 	vk::PhysicalDevice vkPysicalDevice_;
 
-	std::function<void(vk::CommandBuffer, vk::Fence)> addCommand_;
+	//! command pools are owned by each graphics so that graphics which share a device can be used on different threads
+	vk::CommandPool vkCmdPool_;
+
+	SubmissionQueueVulkan* submissionQueue_ = nullptr;
+	vk::PipelineCache pipelineCache_;
 	RenderPassPipelineStateCacheVulkan* renderPassPipelineStateCache_ = nullptr;
+	PipelineStateCacheVulkan* pipelineStateCache_ = nullptr;
 	ReferenceObject* owner_ = nullptr;
 
+	std::unique_ptr<ReadbackBufferPoolVulkan> readbackBufferPool_;
+
+	SubmissionQueueVulkan* transferSubmissionQueue_ = nullptr;
+	vk::CommandPool transferCmdPool_;
+	uint32_t queueFamilyIndex_ = 0;
+	uint32_t transferQueueFamilyIndex_ = 0;
+	bool isTransferQueueEnabled_ = false;
+
+	SubmissionQueueVulkan* computeSubmissionQueue_ = nullptr;
+	vk::CommandPool computeCmdPool_;
+	uint32_t computeQueueFamilyIndex_ = 0;
+	bool isAsyncComputeEnabled_ = false;
+
+	//! the last values which are added by this graphics. queues may be shared with other graphics.
+	uint64_t submittedValue_ = 0;
+	uint64_t computeSubmittedValue_ = 0;
+
+	struct InitialLayoutBatch
+	{
+		vk::CommandBuffer commandBuffer;
+		uint64_t value = 0;
+		std::vector<vk::Semaphore> waitSemaphores;
+		std::vector<TextureVulkan*> textures;
+	};
+
+	struct TransferBatch
+	{
+		vk::CommandBuffer commandBuffer;
+		uint64_t value = 0;
+		vk::Semaphore semaphore;
+		TextureVulkan* texture = nullptr;
+		bool isAcquireRecorded = false;
+	};
+
+	std::mutex initialLayoutMutex_;
+	std::vector<TextureVulkan*> pendingInitialLayoutTextures_;
+	std::vector<InitialLayoutBatch> initialLayoutBatches_;
+	std::vector<TransferBatch> transferBatches_;
+
+	void CollectInitialLayoutBatches(bool waitAll);
+	void CollectTransferBatches(bool waitAll);
+
+	vk::CommandPool CreateCommandPool(uint32_t queueFamilyIndex, vk::CommandPoolCreateFlags flags);
+
 public:
+	/**
+		@param	submissionQueue	a queue which may be shared by graphics on the same device. it is created if it is null.
+		@param	renderPassPipelineStateCache	a cache which may be shared by graphics on the same device. it is created if it is null.
+		@param	pipelineStateCache	a cache which may be shared by graphics on the same device. it is created if it is null.
+	*/
 	GraphicsVulkan(const vk::Device& device,
 				   const vk::Queue& quque,
-				   const vk::CommandPool& commandPool,
+				   uint32_t queueFamilyIndex,
 				   const vk::PhysicalDevice& pysicalDevice,
 				   int32_t swapBufferCount,
-				   std::function<void(vk::CommandBuffer, vk::Fence)> addCommand,
+				   SubmissionQueueVulkan* submissionQueue,
 				   RenderPassPipelineStateCacheVulkan* renderPassPipelineStateCache = nullptr,
+				   PipelineStateCacheVulkan* pipelineStateCache = nullptr,
 				   ReferenceObject* owner = nullptr);
 
 	~GraphicsVulkan() override;
@@ -44,13 +102,18 @@ public:
 
 	void Execute(CommandList* commandList) override;
 
+	void Flush() override;
+
 	void WaitFinish() override;
 
 	Buffer* CreateBuffer(BufferUsageType usage, int32_t size) override;
 	Shader* CreateShader(DataStructure* data, int32_t count) override;
 	PipelineState* CreatePiplineState() override;
+
+	int32_t PrewarmPipelines(const char* manifestPath, Shader** shaders, int32_t shaderCount) override;
 	SingleFrameMemoryPool* CreateSingleFrameMemoryPool(int32_t constantBufferPoolSize, int32_t drawingCount) override;
 	CommandList* CreateCommandList(SingleFrameMemoryPool* memoryPool) override;
+	CommandList* CreateComputeCommandList(SingleFrameMemoryPool* memoryPool) override;
 	RenderPass* CreateRenderPass(Texture** textures, int32_t textureCount, Texture* depthTexture) override;
 
 	RenderPass* CreateRenderPass(Texture* texture, Texture* resolvedTexture, Texture* depthTexture, Texture* resolvedDepthTexture) override;
@@ -73,9 +136,99 @@ public:
 	vk::CommandPool GetCommandPool() const { return vkCmdPool_; }
 	vk::Queue GetQueue() const { return vkQueue_; }
 
+	/**
+		@brief	specify a pipeline cache which is used to compile pipeline states
+		@note
+		The cache is not owned by the graphics. It may be shared by graphics on the same device.
+	*/
+	void SetPipelineCache(vk::PipelineCache pipelineCache) { pipelineCache_ = pipelineCache; }
+	vk::PipelineCache GetPipelineCache() const { return pipelineCache_; }
+
+	PipelineStateCacheVulkan* GetPipelineStateCache() const { return pipelineStateCache_; }
+
+	/**
+		@brief	specify a queue which is used for uploads instead of the graphics queue
+		@note
+		If the queue belongs to the graphics queue family, the graphics queue is used.
+	*/
+	void SetTransferQueue(SubmissionQueueVulkan* queue, uint32_t transferQueueFamilyIndex);
+
+	/**
+		@brief	specify a queue which is used for command lists created by CreateComputeCommandList
+		@note
+		It must be called before resources are created, because buffers are shared between queue families.
+		If the queue is not specified or timeline semaphores are not supported, compute command lists are executed on the graphics queue.
+	*/
+	void SetComputeQueue(SubmissionQueueVulkan* queue, uint32_t computeQueueFamilyIndex);
+
+	bool IsTransferQueueEnabled() const { return isTransferQueueEnabled_; }
+	bool IsAsyncComputeEnabled() const { return isAsyncComputeEnabled_; }
+	vk::CommandPool GetComputeCommandPool() const { return computeCmdPool_; }
+
+	/**
+		@brief	get a queue which command lists are submitted through
+	*/
+	SubmissionQueueVulkan* GetSubmissionQueue(bool isCompute = false) const
+	{
+		return isCompute && isAsyncComputeEnabled_ ? computeSubmissionQueue_ : submissionQueue_;
+	}
+
+	/**
+		@brief	get queue families which share buffers concurrently. it is empty if buffers are not shared.
+	*/
+	std::vector<uint32_t> GetConcurrentQueueFamilyIndices() const;
+	uint32_t GetQueueFamilyIndex() const { return queueFamilyIndex_; }
+	uint32_t GetTransferQueueFamilyIndex() const { return transferQueueFamilyIndex_; }
+
 	int32_t GetSwapBufferCount() const;
+	ReadbackBufferPoolVulkan* GetReadbackBufferPool() const { return readbackBufferPool_.get(); }
 	uint32_t GetMemoryTypeIndex(uint32_t bits, const vk::MemoryPropertyFlags& properties);
 
+	/**
+		@brief	register a texture whose layout must be changed from undefined before it is used on GPU
+		@note
+		Transitions are not submitted one by one. They are recorded together before the next submission.
+	*/
+	void RegisterInitialLayoutTransition(TextureVulkan* texture);
+
+	/**
+		@brief	unregister a texture which is being destroyed. It waits if the transition of the texture is still in flight.
+	*/
+	void UnregisterInitialLayoutTransition(TextureVulkan* texture);
+
+	/**
+		@brief	remove a texture from pending initial transitions and return whether it was pending
+		@note
+		A texture which is removed has not been used on the graphics queue, so its contents can be discarded.
+	*/
+	bool TakeInitialLayoutTransition(TextureVulkan* texture);
+
+	/**
+		@brief	add all pending initial transitions and ownership acquisitions into the submission queue as a single command buffer
+		@note
+		The submission waits semaphores which are signaled by uploads on the transfer queue.
+		Textures stay pending until this is called, so it must be called before any command buffer which uses them is added.
+	*/
+	bool FlushInitialLayoutTransitions();
+
+	/**
+		@brief	begin a command buffer for the transfer queue
+	*/
+	vk::CommandBuffer BeginTransferCommands();
+
+	/**
+		@brief	submit an upload of a texture into the transfer queue without waiting
+		@note
+		The command buffer must release the ownership of the texture to the graphics queue family.
+		The ownership is acquired in the next submission on the graphics queue.
+	*/
+	bool SubmitTransferCommands(vk::CommandBuffer commandBuffer, TextureVulkan* texture);
+
+	/**
+		@brief	wait until uploads of a texture on the transfer queue are finished
+	*/
+	void WaitTransfer(TextureVulkan* texture);
+
 	VkCommandBuffer BeginSingleTimeCommands();
 	bool EndSingleTimeCommands(VkCommandBuffer commandBuffer);
 };
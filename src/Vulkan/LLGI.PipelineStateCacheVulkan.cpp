@@ -0,0 +1,341 @@
+#include "LLGI.PipelineStateCacheVulkan.h"
+#include <cstring>
+#include <fstream>
+
+namespace LLGI
+{
+
+namespace
+{
+
+const char ManifestFileMagic[4] = {'L', 'L', 'P', 'M'};
+const uint32_t ManifestFileVersion = 2;
+
+//! remove expired entries if the number of entries reaches the threshold
+template <typename TKey, typename TValue>
+void SweepExpired(std::unordered_map<TKey, std::weak_ptr<TValue>>& entries, size_t& sweepCount, size_t sweepCountMin)
+{
+	if (entries.size() < sweepCount)
+	{
+		return;
+	}
+
+	for (auto it = entries.begin(); it != entries.end();)
+	{
+		if (it->second.expired())
+		{
+			it = entries.erase(it);
+		}
+		else
+		{
+			it++;
+		}
+	}
+
+	sweepCount = entries.size() * 2 > sweepCountMin ? entries.size() * 2 : sweepCountMin;
+}
+
+} // namespace
+
+PipelineObjectVulkan::PipelineObjectVulkan(vk::Device device) : device_(device)
+{
+	DescriptorSetLayouts.fill(nullptr);
+	BindingMasks.fill(0);
+}
+
+PipelineObjectVulkan::~PipelineObjectVulkan()
+{
+	if (Pipeline)
+	{
+		device_.destroyPipeline(Pipeline);
+	}
+}
+
+ShaderModuleVulkan::ShaderModuleVulkan(vk::Device device) : device_(device) { BindingMasks.fill(0); }
+
+ShaderModuleVulkan::~ShaderModuleVulkan()
+{
+	if (ShaderModule)
+	{
+		device_.destroyShaderModule(ShaderModule);
+	}
+}
+
+PipelineStateCacheVulkan::PipelineStateCacheVulkan(vk::Device device) : device_(device) {}
+
+PipelineStateCacheVulkan::~PipelineStateCacheVulkan()
+{
+	// pinned pipelines use layouts
+	pinnedPipelines_.clear();
+
+	for (auto& it : layouts_)
+	{
+		device_.destroyPipelineLayout(it.second.PipelineLayout);
+
+		for (auto& layout : it.second.DescriptorSetLayouts)
+		{
+			device_.destroyDescriptorSetLayout(layout);
+		}
+	}
+}
+
+std::shared_ptr<PipelineObjectVulkan> PipelineStateCacheVulkan::Find(const std::string& key)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	auto it = pipelines_.find(key);
+	if (it == pipelines_.end())
+	{
+		return nullptr;
+	}
+
+	return it->second.lock();
+}
+
+std::shared_ptr<PipelineObjectVulkan> PipelineStateCacheVulkan::Register(const std::string& key,
+																		 const std::shared_ptr<PipelineObjectVulkan>& pipeline)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	auto& entry = pipelines_[key];
+	auto registered = entry.lock();
+	if (registered != nullptr)
+	{
+		return registered;
+	}
+
+	entry = pipeline;
+
+	if (isManifestRecorded_)
+	{
+		recordedKeys_.insert(key);
+	}
+
+	if (keysToPin_.count(key) != 0)
+	{
+		pinnedPipelines_[key] = pipeline;
+	}
+
+	SweepExpired(pipelines_, sweepCount_, SweepCountMin);
+
+	return pipeline;
+}
+
+std::shared_ptr<ShaderModuleVulkan> PipelineStateCacheVulkan::FindShaderModule(uint64_t hash, size_t codeSize)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	auto it = shaderModules_.find(hash);
+	if (it == shaderModules_.end())
+	{
+		return nullptr;
+	}
+
+	auto shaderModule = it->second.lock();
+	if (shaderModule == nullptr || shaderModule->CodeSize != codeSize)
+	{
+		return nullptr;
+	}
+
+	return shaderModule;
+}
+
+std::shared_ptr<ShaderModuleVulkan> PipelineStateCacheVulkan::RegisterShaderModule(uint64_t hash,
+																				   const std::shared_ptr<ShaderModuleVulkan>& shaderModule)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	auto& entry = shaderModules_[hash];
+	auto registered = entry.lock();
+	if (registered != nullptr)
+	{
+		// a module with a colliding hash is not shared
+		return registered->CodeSize == shaderModule->CodeSize ? registered : shaderModule;
+	}
+
+	entry = shaderModule;
+
+	SweepExpired(shaderModules_, shaderModuleSweepCount_, SweepCountMin);
+
+	return shaderModule;
+}
+
+PipelineLayoutVulkan PipelineStateCacheVulkan::GetPipelineLayout(vk::ShaderStageFlags stages)
+{
+	// constant buffers, textures and compute buffers
+	const std::array<vk::DescriptorType, 3> descriptorTypes = {
+		vk::DescriptorType::eUniformBufferDynamic, vk::DescriptorType::eCombinedImageSampler, vk::DescriptorType::eStorageBufferDynamic};
+	const std::array<uint32_t, 3> slotCounts = {4, TextureSlotMax, 8};
+
+	const auto key = static_cast<VkShaderStageFlags>(stages);
+
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	auto it = layouts_.find(key);
+	if (it != layouts_.end())
+	{
+		return it->second;
+	}
+
+	PipelineLayoutVulkan layout;
+
+	for (size_t i = 0; i < layout.DescriptorSetLayouts.size(); i++)
+	{
+		// bindings which are not used by shaders are declared, otherwise sets are incompatible between pipelines
+		std::vector<vk::DescriptorSetLayoutBinding> layoutBindings;
+
+		for (uint32_t binding = 0; binding < slotCounts[i]; binding++)
+		{
+			vk::DescriptorSetLayoutBinding layoutBinding;
+			layoutBinding.binding = binding;
+			layoutBinding.descriptorType = descriptorTypes[i];
+			layoutBinding.descriptorCount = 1;
+			layoutBinding.stageFlags = stages;
+			layoutBinding.pImmutableSamplers = nullptr;
+			layoutBindings.push_back(layoutBinding);
+		}
+
+		vk::DescriptorSetLayoutCreateInfo descriptorSetLayoutInfo;
+		descriptorSetLayoutInfo.bindingCount = static_cast<uint32_t>(layoutBindings.size());
+		descriptorSetLayoutInfo.pBindings = layoutBindings.data();
+
+		layout.DescriptorSetLayouts[i] = device_.createDescriptorSetLayout(descriptorSetLayoutInfo);
+	}
+
+	vk::PipelineLayoutCreateInfo layoutInfo = {};
+	layoutInfo.setLayoutCount = static_cast<uint32_t>(layout.DescriptorSetLayouts.size());
+	layoutInfo.pSetLayouts = layout.DescriptorSetLayouts.data();
+	layoutInfo.pushConstantRangeCount = 0;
+	layoutInfo.pPushConstantRanges = nullptr;
+
+	layout.PipelineLayout = device_.createPipelineLayout(layoutInfo);
+
+	layouts_[key] = layout;
+	return layout;
+}
+
+WorkerPool* PipelineStateCacheVulkan::GetWorkerPool()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	if (workerPool_ == nullptr)
+	{
+		workerPool_.reset(new WorkerPool());
+	}
+
+	return workerPool_.get();
+}
+
+void PipelineStateCacheVulkan::StartRecordingManifest(const char* path)
+{
+	std::vector<std::string> keys;
+	LoadManifest(path, keys);
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	isManifestRecorded_ = true;
+	recordedKeys_.insert(keys.begin(), keys.end());
+}
+
+bool PipelineStateCacheVulkan::SaveManifest(const char* path)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	std::ofstream file(path, std::ios::binary);
+	if (!file)
+	{
+		Log(LogType::Error, std::string("Failed to open a file to save a pipeline manifest : ") + path);
+		return false;
+	}
+
+	const auto count = static_cast<uint32_t>(recordedKeys_.size());
+	file.write(ManifestFileMagic, sizeof(ManifestFileMagic));
+	file.write(reinterpret_cast<const char*>(&ManifestFileVersion), sizeof(ManifestFileVersion));
+	file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+
+	for (const auto& key : recordedKeys_)
+	{
+		const auto size = static_cast<uint32_t>(key.size());
+		file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+		file.write(key.data(), key.size());
+	}
+
+	if (!file)
+	{
+		Log(LogType::Error, std::string("Failed to save a pipeline manifest : ") + path);
+		return false;
+	}
+
+	return true;
+}
+
+bool PipelineStateCacheVulkan::LoadManifest(const char* path, std::vector<std::string>& keys)
+{
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
+	if (!file)
+	{
+		return false;
+	}
+
+	const auto fileSize = static_cast<uint64_t>(file.tellg());
+	file.seekg(0, std::ios::beg);
+
+	char magic[4];
+	uint32_t version = 0;
+	uint32_t count = 0;
+	file.read(magic, sizeof(magic));
+	file.read(reinterpret_cast<char*>(&version), sizeof(version));
+	file.read(reinterpret_cast<char*>(&count), sizeof(count));
+
+	if (!file || memcmp(magic, ManifestFileMagic, sizeof(magic)) != 0 || version != ManifestFileVersion)
+	{
+		Log(LogType::Warning, std::string("A pipeline manifest is ignored because the format is different : ") + path);
+		return false;
+	}
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		uint32_t size = 0;
+		if (!file.read(reinterpret_cast<char*>(&size), sizeof(size)))
+		{
+			break;
+		}
+
+		// a broken size must not allocate more than the rest of the file
+		if (size > fileSize - static_cast<uint64_t>(file.tellg()))
+		{
+			break;
+		}
+
+		std::string key(size, '\0');
+		if (!file.read(&key[0], size))
+		{
+			break;
+		}
+
+		keys.emplace_back(std::move(key));
+	}
+
+	if (keys.size() != count)
+	{
+		Log(LogType::Warning, std::string("A pipeline manifest is broken : ") + path);
+	}
+
+	return true;
+}
+
+void PipelineStateCacheVulkan::Pin(const std::string& key)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	keysToPin_.insert(key);
+
+	auto it = pipelines_.find(key);
+	if (it != pipelines_.end())
+	{
+		if (auto pipeline = it->second.lock())
+		{
+			pinnedPipelines_[key] = pipeline;
+		}
+	}
+}
+
+} // namespace LLGI
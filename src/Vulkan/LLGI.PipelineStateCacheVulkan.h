@@ -0,0 +1,161 @@
+#pragma once
+
+#include "../Utils/LLGI.WorkerPool.h"
+#include "LLGI.BaseVulkan.h"
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace LLGI
+{
+
+/**
+	@brief	a pipeline which is shared by pipeline states with the same description
+	@note
+	A pipeline is destroyed when the last pipeline state which uses it is destroyed.
+	Layouts are owned by PipelineStateCacheVulkan.
+*/
+class PipelineObjectVulkan
+{
+private:
+	vk::Device device_;
+
+public:
+	PipelineObjectVulkan(vk::Device device);
+	~PipelineObjectVulkan();
+
+	vk::Pipeline Pipeline;
+	vk::PipelineLayout PipelineLayout;
+	std::array<vk::DescriptorSetLayout, 3> DescriptorSetLayouts;
+
+	//! bindings which are used by shaders. Other bindings are declared in layouts but they are not written.
+	std::array<uint32_t, 3> BindingMasks;
+};
+
+/**
+	@brief	a shader module which is shared by shaders with the same code
+*/
+class ShaderModuleVulkan
+{
+private:
+	vk::Device device_;
+
+public:
+	ShaderModuleVulkan(vk::Device device);
+	~ShaderModuleVulkan();
+
+	vk::ShaderModule ShaderModule;
+
+	//! a size of code which is compared in addition to a hash
+	size_t CodeSize = 0;
+
+	//! bindings which are declared in each descriptor set (constant buffers, textures and compute buffers)
+	std::array<uint32_t, 3> BindingMasks;
+};
+
+/**
+	@brief	layouts which are shared by pipelines with the same shader stages
+	@note
+	All bindings are declared even if shaders don't use them, so descriptor sets stay compatible when pipelines are switched.
+*/
+struct PipelineLayoutVulkan
+{
+	vk::PipelineLayout PipelineLayout;
+	std::array<vk::DescriptorSetLayout, 3> DescriptorSetLayouts;
+};
+
+/**
+	@brief	a cache which deduplicates pipelines, layouts and shader modules on a device
+	@note
+	A key must contain all states which are used to create a pipeline.
+	Shaders are identified by hashes of their code and render passes by their keys, so a key is valid after objects which are used to create it are destroyed.
+*/
+class PipelineStateCacheVulkan : public ReferenceObject
+{
+private:
+	//! the number of entries which expired entries are removed at
+	static constexpr size_t SweepCountMin = 64;
+
+	vk::Device device_;
+
+	std::unordered_map<std::string, std::weak_ptr<PipelineObjectVulkan>> pipelines_;
+	size_t sweepCount_ = SweepCountMin;
+
+	std::unordered_map<uint64_t, std::weak_ptr<ShaderModuleVulkan>> shaderModules_;
+	size_t shaderModuleSweepCount_ = SweepCountMin;
+
+	//! it is shared by graphics which are used on different threads
+	std::mutex mutex_;
+
+	//! created when it is required first
+	std::unique_ptr<WorkerPool> workerPool_;
+
+	bool isManifestRecorded_ = false;
+	std::unordered_set<std::string> recordedKeys_;
+
+	//! pipelines which are kept alive after pipeline states are destroyed
+	std::unordered_set<std::string> keysToPin_;
+	std::unordered_map<std::string, std::shared_ptr<PipelineObjectVulkan>> pinnedPipelines_;
+
+	//! layouts are kept until this cache is destroyed because their number is small
+	std::unordered_map<VkShaderStageFlags, PipelineLayoutVulkan> layouts_;
+
+public:
+	PipelineStateCacheVulkan(vk::Device device);
+	~PipelineStateCacheVulkan() override;
+
+	/**
+		@return	null if a pipeline with the key is not alive
+	*/
+	std::shared_ptr<PipelineObjectVulkan> Find(const std::string& key);
+
+	/**
+		@brief	register a pipeline which is created with the key
+		@return	a pipeline which is registered by another thread in the meantime, or the argument
+	*/
+	std::shared_ptr<PipelineObjectVulkan> Register(const std::string& key, const std::shared_ptr<PipelineObjectVulkan>& pipeline);
+
+	/**
+		@param	hash	a hash of code
+		@return	null if a module with the same code is not alive
+	*/
+	std::shared_ptr<ShaderModuleVulkan> FindShaderModule(uint64_t hash, size_t codeSize);
+
+	/**
+		@brief	register a module which is created from code with the hash
+		@return	a module which is registered by another thread in the meantime, or the argument
+	*/
+	std::shared_ptr<ShaderModuleVulkan> RegisterShaderModule(uint64_t hash, const std::shared_ptr<ShaderModuleVulkan>& shaderModule);
+
+	/**
+		@brief	get layouts which are used by pipelines with the shader stages
+		@note
+		Descriptor sets which are allocated with them are compatible with all pipelines with the same shader stages.
+	*/
+	PipelineLayoutVulkan GetPipelineLayout(vk::ShaderStageFlags stages);
+
+	/**
+		@brief	get threads which compile pipelines asynchronously
+		@note
+		Vulkan allows to create pipelines on multiple threads concurrently.
+	*/
+	WorkerPool* GetWorkerPool();
+
+	/**
+		@brief	record keys of pipelines which are registered to save them as a manifest
+		@note
+		Keys in a file are added if the file exists, so the manifest is accumulated over runs.
+	*/
+	void StartRecordingManifest(const char* path);
+
+	bool SaveManifest(const char* path);
+
+	static bool LoadManifest(const char* path, std::vector<std::string>& keys);
+
+	/**
+		@brief	keep a pipeline with the key alive while this cache is alive after it is registered
+	*/
+	void Pin(const std::string& key);
+};
+
+} // namespace LLGI
@@ -1,5 +1,6 @@
 #include "LLGI.PipelineStateVulkan.h"
 #include "LLGI.ShaderVulkan.h"
+#include <cstring>
 
 // for x11
 #undef Always
@@ -7,59 +8,274 @@
 namespace LLGI
 {
 
-PipelineStateVulkan::PipelineStateVulkan()
+namespace
+{
+
+enum class PipelineKeyType : uint8_t
+{
+	Graphics,
+	Compute,
+};
+
+class PipelineKeyWriter
+{
+public:
+	std::string Key;
+
+	template <typename T> bool Process(T& value)
+	{
+		Key.append(reinterpret_cast<const char*>(&value), sizeof(T));
+		return true;
+	}
+
+	template <typename T> bool ProcessEnum(T& value, T last) { return Process(value); }
+};
+
+class PipelineKeyReader
+{
+private:
+	const std::string& key_;
+	size_t offset_ = 0;
+
+public:
+	PipelineKeyReader(const std::string& key) : key_(key) {}
+
+	template <typename T> bool Process(T& value)
+	{
+		if (offset_ + sizeof(T) > key_.size())
+		{
+			return false;
+		}
+
+		memcpy(&value, key_.data() + offset_, sizeof(T));
+		offset_ += sizeof(T);
+		return true;
+	}
+
+	/**
+		@brief	read an enum and check whether it is in a range
+		@note
+		Values are used as indexes of tables, so a key which is written by a different build is rejected.
+	*/
+	template <typename T> bool ProcessEnum(T& value, T last)
+	{
+		if (!Process(value))
+		{
+			return false;
+		}
+
+		const auto index = static_cast<int64_t>(value);
+		return 0 <= index && index <= static_cast<int64_t>(last);
+	}
+
+	bool IsEnd() const { return offset_ == key_.size(); }
+};
+
+//! a key is written and read with the same function to keep the layout consistent
+template <typename S> bool ProcessRenderPassKey(S& s, RenderPassPipelineStateKey& key)
+{
+	auto count = static_cast<int32_t>(key.RenderTargetFormats.size());
+	if (!s.Process(key.IsPresent) || !s.ProcessEnum(key.DepthFormat, TextureFormatType::Unknown) || !s.Process(count))
+	{
+		return false;
+	}
+
+	if (count < 0 || count > RenderTargetMax)
+	{
+		return false;
+	}
+
+	key.RenderTargetFormats.resize(count);
+	for (int32_t i = 0; i < count; i++)
+	{
+		if (!s.ProcessEnum(key.RenderTargetFormats.at(i), TextureFormatType::Unknown))
+		{
+			return false;
+		}
+	}
+
+	return s.Process(key.IsColorCleared) && s.Process(key.IsDepthCleared) && s.Process(key.HasResolvedRenderTarget) &&
+		   s.Process(key.HasResolvedDepthTarget) && s.Process(key.IsColorTransient) && s.Process(key.IsDepthTransient) &&
+		   s.Process(key.SamplingCount);
+}
+
+template <typename S> bool ProcessStates(S& s, PipelineState& state)
+{
+	const auto result =
+		s.ProcessEnum(state.Culling, CullingMode::DoubleSide) && s.ProcessEnum(state.Topology, TopologyType::Point) &&
+		s.Process(state.IsBlendEnabled) && s.ProcessEnum(state.BlendSrcFunc, BlendFuncType::OneMinusDstColor) &&
+		s.ProcessEnum(state.BlendDstFunc, BlendFuncType::OneMinusDstColor) &&
+		s.ProcessEnum(state.BlendSrcFuncAlpha, BlendFuncType::OneMinusDstColor) &&
+		s.ProcessEnum(state.BlendDstFuncAlpha, BlendFuncType::OneMinusDstColor) &&
+		s.ProcessEnum(state.BlendEquationRGB, BlendEquationType::Max) &&
+		s.ProcessEnum(state.BlendEquationAlpha, BlendEquationType::Max) && s.Process(state.IsDepthTestEnabled) &&
+		s.Process(state.IsDepthWriteEnabled) && s.ProcessEnum(state.DepthFunc, DepthFuncType::Always) &&
+		s.Process(state.StencilRef) && s.Process(state.StencilReadMask) && s.Process(state.StencilWriteMask) &&
+		s.ProcessEnum(state.StencilDepthFailOp, StencilOperatorType::DecRepeat) &&
+		s.ProcessEnum(state.StencilFailOp, StencilOperatorType::DecRepeat) &&
+		s.ProcessEnum(state.StencilPassOp, StencilOperatorType::DecRepeat) &&
+		s.ProcessEnum(state.StencilCompareFunc, CompareFuncType::Always) && s.Process(state.IsStencilTestEnabled) &&
+		s.Process(state.VertexLayoutCount);
+
+	if (!result || state.VertexLayoutCount < 0 || state.VertexLayoutCount > VertexLayoutMax)
+	{
+		return false;
+	}
+
+	for (int32_t i = 0; i < state.VertexLayoutCount; i++)
+	{
+		if (!s.ProcessEnum(state.VertexLayouts[i], VertexLayoutFormat::R32_FLOAT))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+} // namespace
+
+PipelineStateVulkan::PipelineStateVulkan() : compileState_(CompileState::NotCompiled)
 {
 	shaders.fill(0);
+	bindingMasks_.fill(0);
+	computeBindingMasks_.fill(0);
 	for (size_t i = 0; i < descriptorSetLayouts_.size(); i++)
 	{
 		descriptorSetLayouts_[i] = nullptr;
 	}
+
+	for (size_t i = 0; i < computeDescriptorSetLayouts_.size(); i++)
+	{
+		computeDescriptorSetLayouts_[i] = nullptr;
+	}
 }
 
 PipelineStateVulkan ::~PipelineStateVulkan()
 {
+	// a compilation on a worker thread holds a reference, so it is finished here
+
+	// pipelines may be used by other pipeline states
+	graphicsPipelineObject_.reset();
+	computePipelineObject_.reset();
+
 	for (auto& shader : shaders)
 	{
 		SafeRelease(shader);
 	}
 
-	for (size_t i = 0; i < descriptorSetLayouts_.size(); i++)
+	SafeRelease(graphics_);
+}
+
+std::string PipelineStateVulkan::CreatePipelineKey()
+{
+	PipelineKeyWriter writer;
+
+	// shaders are identified by their code instead of modules, so that keys are valid after modules are destroyed.
+	// a size is added because a hash may collide
+	const auto processShader = [&writer](ShaderVulkan* shader) -> void {
+		auto hash = shader->GetHash();
+		auto codeSize = shader->GetCodeSize();
+		writer.Process(hash);
+		writer.Process(codeSize);
+	};
+
+	auto computeShader = static_cast<ShaderVulkan*>(shaders[static_cast<int>(ShaderStageType::Compute)]);
+	if (computeShader != nullptr)
 	{
-		graphics_->GetDevice().destroyDescriptorSetLayout(descriptorSetLayouts_[i]);
-		descriptorSetLayouts_[i] = nullptr;
+		auto type = PipelineKeyType::Compute;
+		writer.Process(type);
+		processShader(computeShader);
+		return writer.Key;
 	}
 
-	if (pipelineLayout_)
+	auto type = PipelineKeyType::Graphics;
+	writer.Process(type);
+
+	for (size_t i = 0; i < static_cast<int>(ShaderStageType::Compute); i++)
+	{
+		processShader(static_cast<ShaderVulkan*>(shaders[i]));
+	}
+
+	// pipelines can be used with compatible render passes, which have the same key
+	auto renderPassKey = static_cast<RenderPassPipelineStateVulkan*>(renderPassPipelineState_.get())->Key;
+	ProcessRenderPassKey(writer, renderPassKey);
+	ProcessStates(writer, *this);
+
+	return writer.Key;
+}
+
+bool PipelineStateVulkan::RestoreFromPipelineKey(const std::string& key, const std::unordered_map<uint64_t, Shader*>& shaders)
+{
+	PipelineKeyReader reader(key);
+
+	const auto findShader = [&](ShaderStageType stage) -> bool {
+		uint64_t hash = 0;
+		uint64_t codeSize = 0;
+		if (!reader.Process(hash) || !reader.Process(codeSize))
+		{
+			return false;
+		}
+
+		auto it = shaders.find(hash);
+		if (it == shaders.end() || static_cast<ShaderVulkan*>(it->second)->GetCodeSize() != codeSize)
+		{
+			return false;
+		}
+
+		SetShader(stage, it->second);
+		return true;
+	};
+
+	PipelineKeyType type;
+	if (!reader.Process(type))
 	{
-		graphics_->GetDevice().destroyPipelineLayout(pipelineLayout_);
-		pipelineLayout_ = nullptr;
+		return false;
 	}
 
-	if (pipeline_)
+	if (type == PipelineKeyType::Compute)
 	{
-		graphics_->GetDevice().destroyPipeline(pipeline_);
-		pipeline_ = nullptr;
+		return findShader(ShaderStageType::Compute) && reader.IsEnd();
 	}
 
-	for (size_t i = 0; i < computeDescriptorSetLayouts_.size(); i++)
+	if (type != PipelineKeyType::Graphics || !findShader(ShaderStageType::Vertex) || !findShader(ShaderStageType::Pixel))
 	{
-		graphics_->GetDevice().destroyDescriptorSetLayout(computeDescriptorSetLayouts_[i]);
-		computeDescriptorSetLayouts_[i] = nullptr;
+		return false;
 	}
 
-	if (computePipelineLayout_)
+	RenderPassPipelineStateKey renderPassKey;
+	if (!ProcessRenderPassKey(reader, renderPassKey) || !ProcessStates(reader, *this) || !reader.IsEnd())
 	{
-		graphics_->GetDevice().destroyPipelineLayout(computePipelineLayout_);
-		computePipelineLayout_ = nullptr;
+		return false;
 	}
 
-	if (computePipeline_)
+	auto renderPassPipelineState = graphics_->CreateRenderPassPipelineState(renderPassKey);
+	if (renderPassPipelineState == nullptr)
 	{
-		graphics_->GetDevice().destroyPipeline(computePipeline_);
-		computePipeline_ = nullptr;
+		return false;
 	}
 
-	SafeRelease(graphics_);
+	SetRenderPassPipelineState(renderPassPipelineState);
+	renderPassPipelineState->Release();
+	return true;
+}
+
+void PipelineStateVulkan::SetGraphicsPipelineObject(const std::shared_ptr<PipelineObjectVulkan>& object)
+{
+	graphicsPipelineObject_ = object;
+	pipeline_ = object->Pipeline;
+	pipelineLayout_ = object->PipelineLayout;
+	descriptorSetLayouts_ = object->DescriptorSetLayouts;
+	bindingMasks_ = object->BindingMasks;
+}
+
+void PipelineStateVulkan::SetComputePipelineObject(const std::shared_ptr<PipelineObjectVulkan>& object)
+{
+	computePipelineObject_ = object;
+	computePipeline_ = object->Pipeline;
+	computePipelineLayout_ = object->PipelineLayout;
+	computeDescriptorSetLayouts_ = object->DescriptorSetLayouts;
+	computeBindingMasks_ = object->BindingMasks;
 }
 
 bool PipelineStateVulkan::Initialize(GraphicsVulkan* graphics)
@@ -78,7 +294,7 @@ void PipelineStateVulkan::SetShader(ShaderStageType stage, Shader* shader)
 	shaders[static_cast<int>(stage)] = shader;
 }
 
-bool PipelineStateVulkan::Compile()
+bool PipelineStateVulkan::CompileInternal()
 {
 	if (shaders[static_cast<int>(ShaderStageType::Compute)] != nullptr)
 	{
@@ -88,6 +304,71 @@ bool PipelineStateVulkan::Compile()
 	return CreateGraphicsPipeline();
 }
 
+void PipelineStateVulkan::FinishCompile(bool succeeded)
+{
+	// notify in the lock because this may be destroyed just after waiters wake up
+	std::lock_guard<std::mutex> lock(compileMutex_);
+	compileState_.store(succeeded ? CompileState::Succeeded : CompileState::Failed, std::memory_order_release);
+	compileCondition_.notify_all();
+}
+
+bool PipelineStateVulkan::Compile()
+{
+	WaitUntilReady();
+
+	compileState_.store(CompileState::Compiling, std::memory_order_relaxed);
+
+	bool succeeded = false;
+	try
+	{
+		succeeded = CompileInternal();
+	}
+	catch (...)
+	{
+		FinishCompile(false);
+		throw;
+	}
+
+	FinishCompile(succeeded);
+	return succeeded;
+}
+
+bool PipelineStateVulkan::CompileAsync()
+{
+	WaitUntilReady();
+
+	compileState_.store(CompileState::Compiling, std::memory_order_relaxed);
+
+	// the task keeps this alive, so it may be released on the worker thread
+	auto self = CreateSharedPtr(this, true);
+
+	graphics_->GetPipelineStateCache()->GetWorkerPool()->Enqueue([self]() -> void {
+		bool succeeded = false;
+
+		try
+		{
+			succeeded = self->CompileInternal();
+		}
+		catch (const std::exception& e)
+		{
+			Log(LogType::Error, e.what());
+		}
+
+		self->FinishCompile(succeeded);
+	});
+
+	return true;
+}
+
+bool PipelineStateVulkan::IsReady() const { return compileState_.load(std::memory_order_acquire) == CompileState::Succeeded; }
+
+bool PipelineStateVulkan::WaitUntilReady()
+{
+	std::unique_lock<std::mutex> lock(compileMutex_);
+	compileCondition_.wait(lock, [this]() { return compileState_.load(std::memory_order_acquire) != CompileState::Compiling; });
+	return compileState_.load(std::memory_order_acquire) == CompileState::Succeeded;
+}
+
 bool PipelineStateVulkan::CreateGraphicsPipeline()
 {
 	if (renderPassPipelineState_ == nullptr)
@@ -125,6 +406,18 @@ bool PipelineStateVulkan::CreateGraphicsPipeline()
 	graphicsPipelineInfo.pStages = shaderStageInfos.data();
 	graphicsPipelineInfo.stageCount = static_cast<int32_t>(shaderStageInfos.size());
 
+	// reuse a pipeline which is compiled with the same description
+	auto pipelineStateCache = graphics_->GetPipelineStateCache();
+	const auto key = CreatePipelineKey();
+
+	if (auto cached = pipelineStateCache->Find(key))
+	{
+		SetGraphicsPipelineObject(cached);
+		return true;
+	}
+
+	auto object = std::make_shared<PipelineObjectVulkan>(graphics_->GetDevice());
+
 	// setup layouts
 	std::vector<vk::VertexInputBindingDescription> bindDescs;
 	std::vector<vk::VertexInputAttributeDescription> attribDescs;
@@ -435,75 +728,38 @@ bool PipelineStateVulkan::CreateGraphicsPipeline()
 
 	graphicsPipelineInfo.renderPass = renderPass;
 
-	auto stageFlag = vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment;
+	// layouts are shared by all pipelines with the same stages, and bindings which are used by shaders are written
+	object->BindingMasks.fill(0);
 
-	// uniform layout info
-	std::array<vk::DescriptorSetLayoutBinding, 4> uboLayoutBindings;
-	for (size_t i = 0; i < uboLayoutBindings.size(); i++)
+	for (auto stage : {ShaderStageType::Vertex, ShaderStageType::Pixel})
 	{
-		uboLayoutBindings[i].binding = static_cast<int>(i);
-		uboLayoutBindings[i].descriptorType = vk::DescriptorType::eUniformBufferDynamic;
-		uboLayoutBindings[i].descriptorCount = 1;
-		uboLayoutBindings[i].stageFlags = stageFlag;
-		uboLayoutBindings[i].pImmutableSamplers = nullptr;
-	}
-
-	std::array<vk::DescriptorSetLayoutBinding, TextureSlotMax> textureLayoutBindings;
-
-	for (size_t i = 0; i < textureLayoutBindings.size(); i++)
-	{
-		textureLayoutBindings[i].binding = static_cast<uint32_t>(i);
-		textureLayoutBindings[i].descriptorType = vk::DescriptorType::eCombinedImageSampler;
-		textureLayoutBindings[i].descriptorCount = 1;
-		textureLayoutBindings[i].stageFlags = stageFlag;
-		textureLayoutBindings[i].pImmutableSamplers = nullptr;
-	}
-
-	// compute buffer info(readonly)
-	std::array<vk::DescriptorSetLayoutBinding, 8> computeLayoutBindings;
-
-	for (size_t i = 0; i < computeLayoutBindings.size(); i++)
-	{
-		computeLayoutBindings[i].binding = static_cast<uint32_t>(i);
-		computeLayoutBindings[i].descriptorType = vk::DescriptorType::eStorageBufferDynamic;
-		computeLayoutBindings[i].descriptorCount = 1;
-		computeLayoutBindings[i].stageFlags = stageFlag;
-		computeLayoutBindings[i].pImmutableSamplers = nullptr;
+		auto shader = static_cast<ShaderVulkan*>(shaders[static_cast<int>(stage)]);
+		for (size_t i = 0; i < object->BindingMasks.size(); i++)
+		{
+			object->BindingMasks[i] |= shader->GetBindingMasks()[i];
+		}
 	}
 
-	vk::DescriptorSetLayoutCreateInfo descriptorSetLayoutInfos[3];
-	descriptorSetLayoutInfos[0].bindingCount = static_cast<int32_t>(uboLayoutBindings.size());
-	descriptorSetLayoutInfos[0].pBindings = uboLayoutBindings.data();
-	descriptorSetLayoutInfos[1].bindingCount = static_cast<int32_t>(textureLayoutBindings.size());
-	descriptorSetLayoutInfos[1].pBindings = textureLayoutBindings.data();
-	descriptorSetLayoutInfos[2].bindingCount = static_cast<int32_t>(computeLayoutBindings.size());
-	descriptorSetLayoutInfos[2].pBindings = computeLayoutBindings.data();
-
-	descriptorSetLayouts_[0] = graphics_->GetDevice().createDescriptorSetLayout(descriptorSetLayoutInfos[0]);
-	descriptorSetLayouts_[1] = graphics_->GetDevice().createDescriptorSetLayout(descriptorSetLayoutInfos[1]);
-	descriptorSetLayouts_[2] = graphics_->GetDevice().createDescriptorSetLayout(descriptorSetLayoutInfos[2]);
-
-	vk::PipelineLayoutCreateInfo layoutInfo = {};
-	layoutInfo.setLayoutCount = static_cast<uint32_t>(descriptorSetLayouts_.size());
-	layoutInfo.pSetLayouts = descriptorSetLayouts_.data();
-	layoutInfo.pushConstantRangeCount = 0;
-	layoutInfo.pPushConstantRanges = nullptr;
-
-	pipelineLayout_ = graphics_->GetDevice().createPipelineLayout(layoutInfo);
-	graphicsPipelineInfo.layout = pipelineLayout_;
+	const auto layout = pipelineStateCache->GetPipelineLayout(vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment);
+	object->PipelineLayout = layout.PipelineLayout;
+	object->DescriptorSetLayouts = layout.DescriptorSetLayouts;
+	graphicsPipelineInfo.layout = object->PipelineLayout;
 
 #if VK_HEADER_VERSION >= 136
 	// setup a pipeline
-	const auto pipeline = graphics_->GetDevice().createGraphicsPipeline(nullptr, graphicsPipelineInfo);
+	const auto pipeline = graphics_->GetDevice().createGraphicsPipeline(graphics_->GetPipelineCache(), graphicsPipelineInfo);
 	if (pipeline.result != vk::Result::eSuccess)
 	{
 		throw std::runtime_error("Cannnot create graphicPipeline: " + std::to_string(static_cast<int>(pipeline.result)));
 	}
-	pipeline_ = pipeline.value;
+	object->Pipeline = pipeline.value;
 #else
-	pipeline_ = graphics_->GetDevice().createGraphicsPipeline(nullptr, graphicsPipelineInfo);
+	object->Pipeline = graphics_->GetDevice().createGraphicsPipeline(graphics_->GetPipelineCache(), graphicsPipelineInfo);
 #endif
 
+	// another thread may compile the same pipeline in the meantime
+	SetGraphicsPipelineObject(pipelineStateCache->Register(key, object));
+
 	return true;
 }
 
@@ -526,76 +782,38 @@ bool PipelineStateVulkan::CreateComputePipeline()
 	info.pName = mainName.c_str();
 	computePipelineInfo.stage = info;
 
-	// uniform layout info
+	// reuse a pipeline which is compiled with the same shader
+	auto pipelineStateCache = graphics_->GetPipelineStateCache();
+	const auto key = CreatePipelineKey();
 
-	auto stageFlag = vk::ShaderStageFlagBits::eCompute;
-
-	// uniform layout info
-	std::array<vk::DescriptorSetLayoutBinding, 4> uboLayoutBindings;
-	for (size_t i = 0; i < uboLayoutBindings.size(); i++)
+	if (auto cached = pipelineStateCache->Find(key))
 	{
-		uboLayoutBindings[i].binding = static_cast<int>(i);
-		uboLayoutBindings[i].descriptorType = vk::DescriptorType::eUniformBufferDynamic;
-		uboLayoutBindings[i].descriptorCount = 1;
-		uboLayoutBindings[i].stageFlags = stageFlag;
-		uboLayoutBindings[i].pImmutableSamplers = nullptr;
+		SetComputePipelineObject(cached);
+		return true;
 	}
 
-	std::array<vk::DescriptorSetLayoutBinding, TextureSlotMax> textureLayoutBindings;
+	auto object = std::make_shared<PipelineObjectVulkan>(graphics_->GetDevice());
 
-	for (size_t i = 0; i < textureLayoutBindings.size(); i++)
-	{
-		textureLayoutBindings[i].binding = static_cast<uint32_t>(i);
-		textureLayoutBindings[i].descriptorType = vk::DescriptorType::eCombinedImageSampler;
-		textureLayoutBindings[i].descriptorCount = 1;
-		textureLayoutBindings[i].stageFlags = stageFlag;
-		textureLayoutBindings[i].pImmutableSamplers = nullptr;
-	}
-
-	std::array<vk::DescriptorSetLayoutBinding, 8> computeLayoutBindings;
-
-	for (size_t i = 0; i < computeLayoutBindings.size(); i++)
-	{
-		computeLayoutBindings[i].binding = static_cast<uint32_t>(i);
-		computeLayoutBindings[i].descriptorType = vk::DescriptorType::eStorageBufferDynamic;
-		computeLayoutBindings[i].descriptorCount = 1;
-		computeLayoutBindings[i].stageFlags = stageFlag;
-		computeLayoutBindings[i].pImmutableSamplers = nullptr;
-	}
-
-	vk::DescriptorSetLayoutCreateInfo descriptorSetLayoutInfos[3];
-	descriptorSetLayoutInfos[0].bindingCount = static_cast<int32_t>(uboLayoutBindings.size());
-	descriptorSetLayoutInfos[0].pBindings = uboLayoutBindings.data();
-	descriptorSetLayoutInfos[1].bindingCount = static_cast<int32_t>(textureLayoutBindings.size());
-	descriptorSetLayoutInfos[1].pBindings = textureLayoutBindings.data();
-	descriptorSetLayoutInfos[2].bindingCount = static_cast<int32_t>(computeLayoutBindings.size());
-	descriptorSetLayoutInfos[2].pBindings = computeLayoutBindings.data();
-
-	computeDescriptorSetLayouts_[0] = graphics_->GetDevice().createDescriptorSetLayout(descriptorSetLayoutInfos[0]);
-	computeDescriptorSetLayouts_[1] = graphics_->GetDevice().createDescriptorSetLayout(descriptorSetLayoutInfos[1]);
-	computeDescriptorSetLayouts_[2] = graphics_->GetDevice().createDescriptorSetLayout(descriptorSetLayoutInfos[2]);
-
-	vk::PipelineLayoutCreateInfo layoutInfo = {};
-	layoutInfo.setLayoutCount = 3;
-	layoutInfo.pSetLayouts = computeDescriptorSetLayouts_.data();
-	layoutInfo.pushConstantRangeCount = 0;
-	layoutInfo.pPushConstantRanges = nullptr;
-
-	computePipelineLayout_ = graphics_->GetDevice().createPipelineLayout(layoutInfo);
-	computePipelineInfo.layout = computePipelineLayout_;
+	const auto layout = pipelineStateCache->GetPipelineLayout(vk::ShaderStageFlagBits::eCompute);
+	object->PipelineLayout = layout.PipelineLayout;
+	object->DescriptorSetLayouts = layout.DescriptorSetLayouts;
+	object->BindingMasks = shader->GetBindingMasks();
+	computePipelineInfo.layout = object->PipelineLayout;
 
 #if VK_HEADER_VERSION >= 136
 	// setup a pipeline
-	const auto pipeline = graphics_->GetDevice().createComputePipeline(nullptr, computePipelineInfo);
+	const auto pipeline = graphics_->GetDevice().createComputePipeline(graphics_->GetPipelineCache(), computePipelineInfo);
 	if (pipeline.result != vk::Result::eSuccess)
 	{
 		throw std::runtime_error("Cannnot create graphicPipeline: " + std::to_string(static_cast<int>(pipeline.result)));
 	}
-	computePipeline_ = pipeline.value;
+	object->Pipeline = pipeline.value;
 #else
-	computePipeline_ = graphics_->GetDevice().createComputePipeline(nullptr, computePipelineInfo);
+	object->Pipeline = graphics_->GetDevice().createComputePipeline(graphics_->GetPipelineCache(), computePipelineInfo);
 #endif
 
+	SetComputePipelineObject(pipelineStateCache->Register(key, object));
+
 	return true;
 }
 
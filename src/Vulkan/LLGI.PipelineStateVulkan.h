@@ -4,6 +4,10 @@
 #include "../LLGI.PipelineState.h"
 #include "LLGI.BaseVulkan.h"
 #include "LLGI.GraphicsVulkan.h"
+#include "LLGI.PipelineStateCacheVulkan.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
 
 namespace LLGI
 {
@@ -17,10 +21,35 @@ private:
 	vk::Pipeline pipeline_ = nullptr;
 	vk::PipelineLayout pipelineLayout_ = nullptr;
 	std::array<vk::DescriptorSetLayout, 3> descriptorSetLayouts_;
+	std::array<uint32_t, 3> bindingMasks_;
 
 	vk::Pipeline computePipeline_ = nullptr;
 	vk::PipelineLayout computePipelineLayout_ = nullptr;
 	std::array<vk::DescriptorSetLayout, 3> computeDescriptorSetLayouts_;
+	std::array<uint32_t, 3> computeBindingMasks_;
+
+	//! objects above are owned by them, which are shared by pipeline states with the same description
+	std::shared_ptr<PipelineObjectVulkan> graphicsPipelineObject_;
+	std::shared_ptr<PipelineObjectVulkan> computePipelineObject_;
+
+	enum class CompileState : int32_t
+	{
+		NotCompiled,
+		Compiling,
+		Succeeded,
+		Failed,
+	};
+
+	//! pipelines are read after Succeeded is acquired
+	std::atomic<CompileState> compileState_;
+	std::mutex compileMutex_;
+	std::condition_variable compileCondition_;
+
+	bool CompileInternal();
+	void FinishCompile(bool succeeded);
+
+	void SetGraphicsPipelineObject(const std::shared_ptr<PipelineObjectVulkan>& object);
+	void SetComputePipelineObject(const std::shared_ptr<PipelineObjectVulkan>& object);
 
 	bool CreateGraphicsPipeline();
 	bool CreateComputePipeline();
@@ -35,17 +64,45 @@ public:
 
 	bool Compile() override;
 
+	bool CompileAsync() override;
+
+	bool IsReady() const override;
+
+	bool WaitUntilReady() override;
+
+	/**
+		@brief	create a description which identifies a pipeline
+		@note
+		It is used as a key of PipelineStateCacheVulkan and an entry of a pipeline manifest.
+		Shaders and a render pass pipeline state must be specified.
+	*/
+	std::string CreatePipelineKey();
+
+	/**
+		@brief	restore states, shaders and a render pass pipeline state from a key
+		@param	shaders	shaders which are found with hashes in the key. Their sizes of code must also be same.
+		@return	false if the key is broken or shaders are not found
+	*/
+	bool RestoreFromPipelineKey(const std::string& key, const std::unordered_map<uint64_t, Shader*>& shaders);
+
 	vk::Pipeline GetPipeline() const { return pipeline_; }
 
 	vk::PipelineLayout GetPipelineLayout() const { return pipelineLayout_; }
 
 	const std::array<vk::DescriptorSetLayout, 3>& GetDescriptorSetLayout() const { return descriptorSetLayouts_; }
 
+	/**
+		@brief	get bindings which are used by shaders in each descriptor set
+	*/
+	const std::array<uint32_t, 3>& GetBindingMasks() const { return bindingMasks_; }
+
 	vk::Pipeline GetComputePipeline() const { return computePipeline_; }
 
 	vk::PipelineLayout GetComputePipelineLayout() const { return computePipelineLayout_; }
 
 	const std::array<vk::DescriptorSetLayout, 3>& GetComputeDescriptorSetLayout() const { return computeDescriptorSetLayouts_; }
+
+	const std::array<uint32_t, 3>& GetComputeBindingMasks() const { return computeBindingMasks_; }
 };
 
 } // namespace LLGI
@@ -1,7 +1,11 @@
 #include "LLGI.PlatformVulkan.h"
 #include "LLGI.GraphicsVulkan.h"
+#include "LLGI.SubmissionQueueVulkan.h"
 #include "LLGI.TextureVulkan.h"
+#include <algorithm>
+#include <fstream>
 #include <sstream>
+#include <string.h>
 
 #ifdef _WIN32
 #include <Windows.h>
@@ -10,6 +14,44 @@
 namespace LLGI
 {
 
+namespace
+{
+
+//! a header which is written before data of a pipeline cache
+struct PipelineCacheFileHeader
+{
+	char Magic[4];
+	uint32_t Version;
+	uint32_t VendorID;
+	uint32_t DeviceID;
+	uint32_t DriverVersion;
+	uint8_t PipelineCacheUUID[VK_UUID_SIZE];
+
+	//! to avoid padding
+	uint32_t Reserved;
+
+	uint64_t DataSize;
+};
+
+const char PipelineCacheFileMagic[4] = {'L', 'L', 'P', 'C'};
+const uint32_t PipelineCacheFileVersion = 1;
+
+PipelineCacheFileHeader CreatePipelineCacheFileHeader(const vk::PhysicalDeviceProperties& properties, uint64_t dataSize)
+{
+	PipelineCacheFileHeader header;
+	memcpy(header.Magic, PipelineCacheFileMagic, sizeof(header.Magic));
+	header.Version = PipelineCacheFileVersion;
+	header.VendorID = properties.vendorID;
+	header.DeviceID = properties.deviceID;
+	header.DriverVersion = properties.driverVersion;
+	memcpy(header.PipelineCacheUUID, &properties.pipelineCacheUUID[0], VK_UUID_SIZE);
+	header.Reserved = 0;
+	header.DataSize = dataSize;
+	return header;
+}
+
+} // namespace
+
 #if !defined(NDEBUG)
 VkBool32 PlatformVulkan::DebugMessageCallback(VkDebugReportFlagsEXT flags,
 											  VkDebugReportObjectTypeEXT objType,
@@ -51,10 +93,6 @@ bool PlatformVulkan::CreateSwapChain(Vec2I windowSize, bool waitVSync)
 			for (uint32_t i = 0; i < swapBuffers.size(); i++)
 			{
 				vkDevice_.destroyImageView(swapBuffers[i].view);
-				if (swapBuffers[i].fence)
-				{
-					vkDevice_.destroyFence(swapBuffers[i].fence);
-				}
 
 				SafeRelease(swapBuffers[i].texture);
 			}
@@ -155,7 +193,6 @@ bool PlatformVulkan::CreateSwapChain(Vec2I windowSize, bool waitVSync)
 			swapBuffers[i].image = swapChainImages[i];
 			viewCreateInfo.image = swapChainImages[i];
 			swapBuffers[i].view = vkDevice_.createImageView(viewCreateInfo);
-			swapBuffers[i].fence = vk::Fence();
 
 			swapBuffers[i].texture = new TextureVulkan();
 			if (!swapBuffers[i].texture->InitializeAsScreen(swapBuffers[i].image, swapBuffers[i].view, surfaceFormat, windowSize))
@@ -204,52 +241,49 @@ void PlatformVulkan::CreateRenderPass()
 	}
 }
 
-uint32_t PlatformVulkan::AcquireNextImage(vk::Semaphore& semaphore)
+vk::Result PlatformVulkan::AcquireNextImage(vk::Semaphore semaphore)
 {
-	auto resultValue = vkDevice_.acquireNextImageKHR(swapchain_, UINT64_MAX, semaphore, vk::Fence());
-	assert(resultValue.result == vk::Result::eSuccess);
+	const auto timeout = acquireTimeout_ < 0 ? UINT64_MAX : static_cast<uint64_t>(acquireTimeout_) * 1000 * 1000;
 
-	frameIndex = resultValue.value;
-	return frameIndex;
-}
+	// the swapchain may be presented on the submission thread
+	std::lock_guard<std::mutex> lock(submissionQueue_->GetPresentMutex());
 
-vk::Fence PlatformVulkan::GetSubmitFence(bool destroy)
-{
-	auto& image = swapBuffers[frameIndex];
-	while (image.fence)
+	try
 	{
-		vk::Result fenceRes = vkDevice_.waitForFences(image.fence, VK_TRUE, std::numeric_limits<int>::max());
-		if (fenceRes == vk::Result::eSuccess)
+		auto resultValue = vkDevice_.acquireNextImageKHR(swapchain_, timeout, semaphore, vk::Fence());
+		if (resultValue.result == vk::Result::eSuccess || resultValue.result == vk::Result::eSuboptimalKHR)
 		{
-			if (destroy)
-			{
-				vkDevice_.destroyFence(image.fence);
-			}
-			image.fence = vk::Fence();
+			frameIndex = resultValue.value;
 		}
+		return resultValue.result;
+	}
+	catch (const vk::OutOfDateKHRError&)
+	{
+		return vk::Result::eErrorOutOfDateKHR;
 	}
-
-	image.fence = vkDevice_.createFence(vk::FenceCreateFlags());
-	return image.fence;
 }
 
-vk::Result PlatformVulkan::Present(vk::Semaphore semaphore)
+std::vector<std::unique_lock<std::mutex>> PlatformVulkan::LockIdleQueues()
 {
-	vk::PresentInfoKHR presentInfo;
-	presentInfo.swapchainCount = 1;
-	presentInfo.pSwapchains = &swapchain_;
-	presentInfo.pImageIndices = &frameIndex;
-	presentInfo.waitSemaphoreCount = semaphore ? 1 : 0;
-	presentInfo.pWaitSemaphores = &semaphore;
+	std::vector<std::unique_lock<std::mutex>> locks;
 
-	try
+	for (auto queue : {submissionQueue_, transferSubmissionQueue_, computeSubmissionQueue_})
 	{
-		return vkQueue.presentKHR(presentInfo);
-	}
-	catch (const vk::OutOfDateKHRError&)
-	{
-		return vk::Result::eErrorOutOfDateKHR;
+		if (queue != nullptr)
+		{
+			locks.emplace_back(queue->LockIdle());
+		}
 	}
+
+	return locks;
+}
+
+void PlatformVulkan::RecreateSwapChain()
+{
+	auto locks = LockIdleQueues();
+	CreateSwapChain(windowSize_, waitVSync_);
+	CreateDepthBuffer(windowSize_);
+	CreateRenderPass();
 }
 
 void PlatformVulkan::Reset()
@@ -263,11 +297,6 @@ void PlatformVulkan::Reset()
 				vkDevice_.destroyImageView(swapBuffer.view);
 			}
 
-			if (swapBuffer.fence)
-			{
-				vkDevice_.destroyFence(swapBuffer.fence);
-			}
-
 			SafeRelease(swapBuffer.texture);
 		}
 		swapBuffers.clear();
@@ -284,27 +313,38 @@ void PlatformVulkan::Reset()
 
 		if (vkPipelineCache_)
 		{
+			if (!pipelineCachePath_.empty())
+			{
+				SavePipelineCache(pipelineCachePath_.c_str());
+			}
+
 			vkDevice_.destroyPipelineCache(vkPipelineCache_);
 			vkPipelineCache_ = nullptr;
 		}
 
-		if (vkPresentComplete_)
-		{
-			vkDevice_.destroySemaphore(vkPresentComplete_);
-			vkPresentComplete_ = nullptr;
-		}
+		SafeRelease(submissionQueue_);
+		SafeRelease(transferSubmissionQueue_);
+		SafeRelease(computeSubmissionQueue_);
 
-		if (vkRenderComplete_)
+		for (auto& frame : framesInFlight_)
 		{
-			vkDevice_.destroySemaphore(vkRenderComplete_);
-			vkRenderComplete_ = nullptr;
-		}
+			if (frame.presentComplete)
+			{
+				vkDevice_.destroySemaphore(frame.presentComplete);
+			}
 
-		if (vkCmdBuffers.size() > 0)
-		{
-			vkDevice_.freeCommandBuffers(vkCmdPool_, vkCmdBuffers);
-			vkCmdBuffers.clear();
+			if (frame.renderComplete)
+			{
+				vkDevice_.destroySemaphore(frame.renderComplete);
+			}
+
+			if (frame.commandBuffer)
+			{
+				vkDevice_.freeCommandBuffers(vkCmdPool_, frame.commandBuffer);
+			}
 		}
+		framesInFlight_.clear();
+		currentFrameInFlight_ = 0;
 
 		if (vkCmdPool_)
 		{
@@ -386,11 +426,25 @@ PlatformVulkan::~PlatformVulkan()
 	// destroy vulkan
 
 	// wait
-	if (vkQueue)
+	if (submissionQueue_)
+	{
+		submissionQueue_->WaitIdle();
+	}
+	else if (vkQueue)
 	{
 		vkQueue.waitIdle();
 	}
 
+	if (transferSubmissionQueue_)
+	{
+		transferSubmissionQueue_->WaitIdle();
+	}
+
+	if (computeSubmissionQueue_)
+	{
+		computeSubmissionQueue_->WaitIdle();
+	}
+
 	if (vkDevice_)
 	{
 		vkDevice_.waitIdle();
@@ -411,6 +465,12 @@ PlatformVulkan::~PlatformVulkan()
 	}
 	*/
 
+	if (pipelineStateCache_ != nullptr && !pipelineManifestPath_.empty())
+	{
+		pipelineStateCache_->SaveManifest(pipelineManifestPath_.c_str());
+	}
+
+	SafeRelease(pipelineStateCache_);
 	SafeRelease(renderPassPipelineStateCache_);
 
 	if (vkDevice_)
@@ -432,10 +492,18 @@ PlatformVulkan::~PlatformVulkan()
 	}
 }
 
-bool PlatformVulkan::Initialize(Window* window, bool waitVSync)
+bool PlatformVulkan::Initialize(Window* window, const PlatformParameter& parameter)
 {
 	window_ = window;
-	waitVSync_ = waitVSync;
+	waitVSync_ = parameter.WaitVSync;
+	acquireTimeout_ = parameter.AcquireTimeout;
+	isHeadless_ = parameter.Headless;
+
+	if (window == nullptr && !isHeadless_)
+	{
+		Log(LogType::Error, "A window is required except in headless mode.");
+		return false;
+	}
 
 	// initialize Vulkan context
 
@@ -447,19 +515,40 @@ bool PlatformVulkan::Initialize(Window* window, bool waitVSync)
 	appInfo.apiVersion = VK_API_VERSION_1_0;
 
 	// specify extension
-	const std::vector<const char*> extensions = {
-		VK_KHR_SURFACE_EXTENSION_NAME,
-#ifdef _WIN32
-		VK_KHR_WIN32_SURFACE_EXTENSION_NAME,
-#else
-		VK_KHR_XCB_SURFACE_EXTENSION_NAME,
-#endif
+	std::vector<const char*> extensions = {
 #if !defined(NDEBUG)
 		VK_EXT_DEBUG_REPORT_EXTENSION_NAME,
 		VK_EXT_DEBUG_UTILS_EXTENSION_NAME,
 #endif
 	};
 
+	if (!isHeadless_)
+	{
+		extensions.push_back(VK_KHR_SURFACE_EXTENSION_NAME);
+#ifdef _WIN32
+		extensions.push_back(VK_KHR_WIN32_SURFACE_EXTENSION_NAME);
+#else
+		extensions.push_back(VK_KHR_XCB_SURFACE_EXTENSION_NAME);
+#endif
+	}
+
+	// VK_KHR_timeline_semaphore depends on it on Vulkan 1.0
+	uint32_t instanceExtensionCount = 0;
+	vkEnumerateInstanceExtensionProperties(nullptr, &instanceExtensionCount, nullptr);
+
+	std::vector<VkExtensionProperties> instanceExtensions(instanceExtensionCount);
+	vkEnumerateInstanceExtensionProperties(nullptr, &instanceExtensionCount, instanceExtensions.data());
+
+	const bool isPhysicalDeviceProperties2Enabled =
+		std::any_of(instanceExtensions.begin(), instanceExtensions.end(), [](const VkExtensionProperties& p) {
+			return strcmp(p.extensionName, VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME) == 0;
+		});
+
+	if (isPhysicalDeviceProperties2Enabled)
+	{
+		extensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+	}
+
 	auto exitWithError = [this]() -> void {
 		Reset();
 
@@ -526,17 +615,20 @@ bool PlatformVulkan::Initialize(Window* window, bool waitVSync)
 		// vk::PhysicalDeviceMemoryProperties deviceMemoryProperties = vkPhysicalDevice.getMemoryProperties();
 
 		// create surface
+		if (!isHeadless_)
+		{
 #ifdef _WIN32
-		vk::Win32SurfaceCreateInfoKHR surfaceCreateInfo;
-		surfaceCreateInfo.hinstance = (HINSTANCE)window->GetNativePtr(1);
-		surfaceCreateInfo.hwnd = (HWND)window->GetNativePtr(0);
-		surface_ = vkInstance_.createWin32SurfaceKHR(surfaceCreateInfo);
+			vk::Win32SurfaceCreateInfoKHR surfaceCreateInfo;
+			surfaceCreateInfo.hinstance = (HINSTANCE)window->GetNativePtr(1);
+			surfaceCreateInfo.hwnd = (HWND)window->GetNativePtr(0);
+			surface_ = vkInstance_.createWin32SurfaceKHR(surfaceCreateInfo);
 #else
-		vk::XcbSurfaceCreateInfoKHR surfaceCreateInfo;
-		surfaceCreateInfo.connection = XGetXCBConnection((Display*)window->GetNativePtr(0));
-		surfaceCreateInfo.window = ((::Window)window->GetNativePtr(1));
-		surface_ = vkInstance_.createXcbSurfaceKHR(surfaceCreateInfo);
+			vk::XcbSurfaceCreateInfoKHR surfaceCreateInfo;
+			surfaceCreateInfo.connection = XGetXCBConnection((Display*)window->GetNativePtr(0));
+			surfaceCreateInfo.window = ((::Window)window->GetNativePtr(1));
+			surface_ = vkInstance_.createXcbSurfaceKHR(surfaceCreateInfo);
 #endif
+		}
 		// create device
 
 		// find queue for graphics
@@ -554,6 +646,20 @@ bool PlatformVulkan::Initialize(Window* window, bool waitVSync)
 			}
 		}
 
+		// a queue which supports only compute is used to run compute shaders on a render server
+		if (graphicsQueueInd < 0 && isHeadless_)
+		{
+			for (size_t i = 0; i < queueFamilyProperties.size(); i++)
+			{
+				if (queueFamilyProperties[i].queueFlags & vk::QueueFlagBits::eCompute)
+				{
+					graphicsQueueInd = static_cast<int32_t>(i);
+					Log(LogType::Warning, "A graphics queue is not found. A compute queue is used instead.");
+					break;
+				}
+			}
+		}
+
 		if (graphicsQueueInd < 0)
 		{
 			exitWithError();
@@ -561,22 +667,93 @@ bool PlatformVulkan::Initialize(Window* window, bool waitVSync)
 			return false;
 		}
 
+		// find a dedicated queue for transfer (it is often backed by DMA engines)
+		int32_t transferQueueInd = graphicsQueueInd;
+
+		for (size_t i = 0; i < queueFamilyProperties.size(); i++)
+		{
+			auto& queueProp = queueFamilyProperties[i];
+			if ((queueProp.queueFlags & vk::QueueFlagBits::eTransfer) && !(queueProp.queueFlags & vk::QueueFlagBits::eGraphics) &&
+				!(queueProp.queueFlags & vk::QueueFlagBits::eCompute) && queueProp.queueCount > 0)
+			{
+				transferQueueInd = static_cast<int32_t>(i);
+				break;
+			}
+		}
+
+		// find a dedicated queue for asynchronous compute
+		int32_t computeQueueInd = -1;
+
+		for (size_t i = 0; i < queueFamilyProperties.size(); i++)
+		{
+			auto& queueProp = queueFamilyProperties[i];
+			if ((queueProp.queueFlags & vk::QueueFlagBits::eCompute) && !(queueProp.queueFlags & vk::QueueFlagBits::eGraphics) &&
+				queueProp.queueCount > 0 && static_cast<int32_t>(i) != graphicsQueueInd)
+			{
+				computeQueueInd = static_cast<int32_t>(i);
+				break;
+			}
+		}
+
 		float queuePriorities[] = {0.0f};
-		vk::DeviceQueueCreateInfo queueCreateInfo;
-		queueCreateInfo.queueFamilyIndex = graphicsQueueInd;
-		queueCreateInfo.queueCount = 1;
-		queueCreateInfo.pQueuePriorities = queuePriorities;
-		queueFamilyIndex_ = queueCreateInfo.queueFamilyIndex;
-
-		const std::vector<const char*> enabledExtensions = {
-			VK_KHR_SWAPCHAIN_EXTENSION_NAME,
+		std::vector<vk::DeviceQueueCreateInfo> queueCreateInfos;
+		for (auto queueInd : {graphicsQueueInd, transferQueueInd, computeQueueInd})
+		{
+			if (queueInd < 0 || std::any_of(queueCreateInfos.begin(), queueCreateInfos.end(), [&](const vk::DeviceQueueCreateInfo& info) {
+					return info.queueFamilyIndex == static_cast<uint32_t>(queueInd);
+				}))
+			{
+				continue;
+			}
+
+			vk::DeviceQueueCreateInfo queueCreateInfo;
+			queueCreateInfo.queueFamilyIndex = queueInd;
+			queueCreateInfo.queueCount = 1;
+			queueCreateInfo.pQueuePriorities = queuePriorities;
+			queueCreateInfos.push_back(queueCreateInfo);
+		}
+
+		queueFamilyIndex_ = graphicsQueueInd;
+		transferQueueFamilyIndex_ = transferQueueInd;
+		computeQueueFamilyIndex_ = computeQueueInd;
+
+		// timeline semaphores are required to express dependencies between queues
+		uint32_t deviceExtensionCount = 0;
+		vkEnumerateDeviceExtensionProperties(static_cast<VkPhysicalDevice>(vkPhysicalDevice), nullptr, &deviceExtensionCount, nullptr);
+
+		std::vector<VkExtensionProperties> deviceExtensions(deviceExtensionCount);
+		vkEnumerateDeviceExtensionProperties(
+			static_cast<VkPhysicalDevice>(vkPhysicalDevice), nullptr, &deviceExtensionCount, deviceExtensions.data());
+
+		isTimelineSemaphoreSupported_ =
+			isPhysicalDeviceProperties2Enabled &&
+			std::any_of(deviceExtensions.begin(), deviceExtensions.end(), [](const VkExtensionProperties& p) {
+				return strcmp(p.extensionName, VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME) == 0;
+			});
+
+		std::vector<const char*> enabledExtensions = {
 #if !defined(NDEBUG)
 		// VK_EXT_DEBUG_MARKER_EXTENSION_NAME,
 #endif
 		};
+
+		if (!isHeadless_)
+		{
+			enabledExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+		}
+
+		vk::PhysicalDeviceTimelineSemaphoreFeatures timelineSemaphoreFeatures;
+		timelineSemaphoreFeatures.timelineSemaphore = true;
+
+		if (isTimelineSemaphoreSupported_)
+		{
+			enabledExtensions.push_back(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+		}
+
 		vk::DeviceCreateInfo deviceCreateInfo;
-		deviceCreateInfo.queueCreateInfoCount = 1;
-		deviceCreateInfo.pQueueCreateInfos = &queueCreateInfo;
+		deviceCreateInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
+		deviceCreateInfo.pQueueCreateInfos = queueCreateInfos.data();
+		deviceCreateInfo.pNext = isTimelineSemaphoreSupported_ ? &timelineSemaphoreFeatures : nullptr;
 		deviceCreateInfo.pEnabledFeatures = &deviceFeatures;
 		deviceCreateInfo.enabledExtensionCount = static_cast<uint32_t>(enabledExtensions.size());
 		deviceCreateInfo.ppEnabledExtensionNames = enabledExtensions.data();
@@ -618,59 +795,121 @@ bool PlatformVulkan::Initialize(Window* window, bool waitVSync)
 
 		vkPipelineCache_ = vkDevice_.createPipelineCache(vk::PipelineCacheCreateInfo());
 
+		pipelineCachePath_ = parameter.PipelineCachePath;
+		if (!pipelineCachePath_.empty())
+		{
+			// the file doesn't exist in the first run
+			LoadPipelineCache(pipelineCachePath_.c_str());
+		}
+
 		vkQueue = vkDevice_.getQueue(graphicsQueueInd, 0);
 
+		submissionQueue_ = new SubmissionQueueVulkan();
+		if (!submissionQueue_->Initialize(vkDevice_, vkQueue, isTimelineSemaphoreSupported_, parameter.UseSubmissionThread))
+		{
+			Log(LogType::Error, "Failed to initialize a submission queue.");
+			exitWithError();
+			return false;
+		}
+
 		// create command pool
 		vk::CommandPoolCreateInfo cmdPoolInfo;
 		cmdPoolInfo.queueFamilyIndex = graphicsQueueInd;
 		cmdPoolInfo.flags = vk::CommandPoolCreateFlagBits::eResetCommandBuffer;
 		vkCmdPool_ = vkDevice_.createCommandPool(cmdPoolInfo);
 
-		// get supported formats
-		auto surfaceFormats = vkPhysicalDevice.getSurfaceFormatsKHR(surface_);
-
-		surfaceFormat = vk::Format::eR8G8B8A8Unorm;
-		if (surfaceFormats[0].format != vk::Format::eUndefined)
+		// queues are shared by graphics. command pools are created by each graphics.
+		if (transferQueueInd != graphicsQueueInd)
 		{
-			surfaceFormat = surfaceFormats[0].format;
+			transferSubmissionQueue_ = new SubmissionQueueVulkan();
+			if (!transferSubmissionQueue_->Initialize(vkDevice_, vkDevice_.getQueue(transferQueueInd, 0), isTimelineSemaphoreSupported_))
+			{
+				Log(LogType::Error, "Failed to initialize a transfer queue.");
+				exitWithError();
+				return false;
+			}
 		}
 
-		surfaceColorSpace = surfaceFormats[0].colorSpace;
-
-		// create swapchain
-		if (!vkPhysicalDevice.getSurfaceSupportKHR(graphicsQueueInd, surface_))
+		if (computeQueueInd >= 0)
 		{
+			computeSubmissionQueue_ = new SubmissionQueueVulkan();
+			if (!computeSubmissionQueue_->Initialize(vkDevice_, vkDevice_.getQueue(computeQueueInd, 0), isTimelineSemaphoreSupported_))
+			{
+				Log(LogType::Error, "Failed to initialize a compute queue.");
+				exitWithError();
+				return false;
+			}
 		}
 
-		if (!CreateSwapChain(window->GetWindowSize(), waitVSync))
+		if (!isHeadless_)
 		{
-			Log(LogType::Error, "Swapchain is not supported.");
-			exitWithError();
-			return false;
-		}
+			// get supported formats
+			auto surfaceFormats = vkPhysicalDevice.getSurfaceFormatsKHR(surface_);
 
-		// create semaphore
-		vk::SemaphoreCreateInfo semaphoreCreateInfo;
+			surfaceFormat = vk::Format::eR8G8B8A8Unorm;
+			if (surfaceFormats[0].format != vk::Format::eUndefined)
+			{
+				surfaceFormat = surfaceFormats[0].format;
+			}
+
+			surfaceColorSpace = surfaceFormats[0].colorSpace;
+
+			// create swapchain
+			if (!vkPhysicalDevice.getSurfaceSupportKHR(graphicsQueueInd, surface_))
+			{
+			}
+
+			if (!CreateSwapChain(window->GetWindowSize(), waitVSync_))
+			{
+				Log(LogType::Error, "Swapchain is not supported.");
+				exitWithError();
+				return false;
+			}
+		}
 
-		vkPresentComplete_ = vkDevice_.createSemaphore(semaphoreCreateInfo);
+		// create semaphores and command buffers for each frame in flight
+		framesInFlight_.resize(std::max(parameter.FrameCountInFlight, 1));
 
-		vkRenderComplete_ = vkDevice_.createSemaphore(semaphoreCreateInfo);
+		// resources which are used in a frame are buffered as many as frames in flight without a swapchain
+		if (isHeadless_)
+		{
+			swapBufferCount = static_cast<int32_t>(framesInFlight_.size());
+		}
 
-		// create command buffer
 		vk::CommandBufferAllocateInfo allocInfo;
 		allocInfo.commandPool = vkCmdPool_;
-		allocInfo.commandBufferCount = swapBufferCount;
-		vkCmdBuffers = vkDevice_.allocateCommandBuffers(allocInfo);
+		allocInfo.commandBufferCount = static_cast<uint32_t>(framesInFlight_.size());
+		auto cmdBuffers = vkDevice_.allocateCommandBuffers(allocInfo);
+
+		vk::SemaphoreCreateInfo semaphoreCreateInfo;
 
-		// create depth buffer
-		if (!CreateDepthBuffer(window->GetWindowSize()))
+		for (size_t i = 0; i < framesInFlight_.size(); i++)
 		{
-			exitWithError();
-			return false;
+			framesInFlight_[i].presentComplete = vkDevice_.createSemaphore(semaphoreCreateInfo);
+			framesInFlight_[i].renderComplete = vkDevice_.createSemaphore(semaphoreCreateInfo);
+			framesInFlight_[i].commandBuffer = cmdBuffers[i];
+		}
+
+		if (!isHeadless_)
+		{
+			// create depth buffer
+			if (!CreateDepthBuffer(window->GetWindowSize()))
+			{
+				exitWithError();
+				return false;
+			}
+
+			windowSize_ = window->GetWindowSize();
 		}
 
-		windowSize_ = window->GetWindowSize();
 		renderPassPipelineStateCache_ = new RenderPassPipelineStateCacheVulkan(vkDevice_, nullptr);
+		pipelineStateCache_ = new PipelineStateCacheVulkan(vkDevice_);
+
+		pipelineManifestPath_ = parameter.PipelineManifestPath;
+		if (!pipelineManifestPath_.empty())
+		{
+			pipelineStateCache_->StartRecordingManifest(pipelineManifestPath_.c_str());
+		}
 
 		// create renderpasses
 		CreateRenderPass();
@@ -692,76 +931,91 @@ bool PlatformVulkan::Initialize(Window* window, bool waitVSync)
 
 bool PlatformVulkan::NewFrame()
 {
-	if (!window_->OnNewFrame())
+	if (window_ != nullptr && !window_->OnNewFrame())
 	{
 		return false;
 	}
 
+	isFrameSkipped_ = false;
+
+	auto& frame = framesInFlight_[currentFrameInFlight_];
+
+	// CPU waits only when it is ahead of GPU by the number of frames in flight
+	if (!submissionQueue_->Wait(frame.submittedValue))
+	{
+		Log(LogType::Error, "Failed to wait a frame in flight.");
+	}
+
 	if (IsSwapchainValid())
 	{
-		AcquireNextImage(vkPresentComplete_);
+		const auto result = AcquireNextImage(frame.presentComplete);
+		if (result == vk::Result::eSuccess || result == vk::Result::eSuboptimalKHR)
+		{
+			// commands which render to the swap buffer wait until the image is released by the presentation engine
+			SubmissionQueueVulkan::SemaphoreOperation wait;
+			wait.Semaphore = frame.presentComplete;
+			wait.Stage = vk::PipelineStageFlagBits::eColorAttachmentOutput;
+			submissionQueue_->Add(vk::CommandBuffer(), {wait});
+		}
+		else
+		{
+			isFrameSkipped_ = true;
+
+			if (result == vk::Result::eErrorOutOfDateKHR)
+			{
+				RecreateSwapChain();
+			}
+		}
 	}
-	executedCommandCount = 0;
+
 	return true;
 }
 
 void PlatformVulkan::Present()
 {
-	if (!IsSwapchainValid())
+	auto& frame = framesInFlight_[currentFrameInFlight_];
+
+	if (isFrameSkipped_ || !IsSwapchainValid())
 	{
+		// command lists are executed even if nothing is presented, and they are waited when this slot is reused
+		frame.submittedValue = submissionQueue_->Add(vk::CommandBuffer());
+		submissionQueue_->Flush();
+		currentFrameInFlight_ = (currentFrameInFlight_ + 1) % static_cast<int32_t>(framesInFlight_.size());
 		return;
 	}
+	auto texture = swapBuffers[frameIndex].texture;
 
-	// waiting or empty command
-	auto& cmdBuffer = vkCmdBuffers[frameIndex];
-
-	cmdBuffer.reset(vk::CommandBufferResetFlagBits::eReleaseResources);
-	vk::CommandBufferBeginInfo cmdBufInfo;
-	cmdBuffer.begin(cmdBufInfo);
-
-	if (swapBuffers[frameIndex].texture->GetImageLayouts()[0] != vk::ImageLayout::ePresentSrcKHR)
+	// the screen render pass changes the layout at the end, so a command buffer is required only when the screen is not rendered
+	vk::CommandBuffer cmdBuffer;
+	if (texture->GetImageLayouts()[0] != vk::ImageLayout::ePresentSrcKHR)
 	{
-		swapBuffers[frameIndex].texture->ResourceBarrier(cmdBuffer, vk::ImageLayout::eColorAttachmentOptimal);
-		swapBuffers[frameIndex].texture->ResourceBarrier(cmdBuffer, vk::ImageLayout::ePresentSrcKHR);
+		cmdBuffer = frame.commandBuffer;
+		cmdBuffer.reset(vk::CommandBufferResetFlagBits::eReleaseResources);
+		vk::CommandBufferBeginInfo cmdBufInfo;
+		cmdBufInfo.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit;
+		cmdBuffer.begin(cmdBufInfo);
+		texture->ResourceBarrier(cmdBuffer, vk::ImageLayout::eColorAttachmentOptimal);
+		texture->ResourceBarrier(cmdBuffer, vk::ImageLayout::ePresentSrcKHR);
+		cmdBuffer.end();
 	}
 
-	cmdBuffer.end();
+	// set a semaphore which notify to finish to execute commands
+	SubmissionQueueVulkan::SemaphoreOperation signal;
+	signal.Semaphore = frame.renderComplete;
 
+	// command lists which are executed in this frame are submitted together, and they are waited when this slot is reused
+	frame.submittedValue = submissionQueue_->Add(cmdBuffer, {}, {signal});
+	if (!submissionQueue_->Flush())
 	{
-		vk::PipelineStageFlags pipelineStages = vk::PipelineStageFlagBits::eBottomOfPipe;
-		vk::SubmitInfo submitInfo;
-		submitInfo.pWaitDstStageMask = &pipelineStages;
-
-		// send semaphore to be need to wait
-		submitInfo.waitSemaphoreCount = 1;
-		submitInfo.pWaitSemaphores = &vkPresentComplete_;
-
-		// set command
-		submitInfo.commandBufferCount = 1;
-		submitInfo.pCommandBuffers = &cmdBuffer;
-
-		// set a semaphore which notify to finish to execute commands
-		submitInfo.signalSemaphoreCount = 1;
-		submitInfo.pSignalSemaphores = &vkRenderComplete_;
-
-		vk::Fence fence = GetSubmitFence(true);
-		vkQueue.submit(submitInfo, fence);
-		vk::Result fenceRes = vkDevice_.waitForFences(fence, VK_TRUE, std::numeric_limits<int>::max());
-		if (fenceRes != vk::Result::eSuccess)
-		{
-			throw "Invalid waitForFences";
-		}
+		return;
 	}
 
-	const auto result = Present(vkRenderComplete_);
+	currentFrameInFlight_ = (currentFrameInFlight_ + 1) % static_cast<int32_t>(framesInFlight_.size());
 
-	// TODO optimize it
+	const auto result = submissionQueue_->Present(swapchain_, frameIndex, frame.renderComplete);
 	if (result == vk::Result::eErrorOutOfDateKHR)
 	{
-		vkDevice_.waitIdle();
-		CreateSwapChain(windowSize_, waitVSync_);
-		CreateDepthBuffer(windowSize_);
-		CreateRenderPass();
+		RecreateSwapChain();
 	}
 }
 
@@ -772,7 +1026,13 @@ void PlatformVulkan::SetWindowSize(const Vec2I& windowSize)
 		return;
 	}
 
-	vkDevice_.waitIdle();
+	if (isHeadless_)
+	{
+		windowSize_ = windowSize;
+		return;
+	}
+
+	auto locks = LockIdleQueues();
 	CreateSwapChain(windowSize, waitVSync_);
 
 	CreateDepthBuffer(windowSize);
@@ -783,32 +1043,95 @@ void PlatformVulkan::SetWindowSize(const Vec2I& windowSize)
 
 Graphics* PlatformVulkan::CreateGraphics()
 {
-	auto addCommand = [this](vk::CommandBuffer commandBuffer, vk::Fence fence) -> void {
-		std::array<vk::SubmitInfo, 1> copySubmitInfos;
-		copySubmitInfos[0].commandBufferCount = 1;
-		copySubmitInfos[0].pCommandBuffers = &commandBuffer;
-		const auto submitResult = vkQueue.submit(static_cast<uint32_t>(copySubmitInfos.size()), copySubmitInfos.data(), fence);
-		if (submitResult != vk::Result::eSuccess)
-		{
-			LLGI::Log(LogType::Error, "Failed to submit");
-			return;
-		}
-
-		this->executedCommandCount++;
-	};
-
 	auto graphics = new GraphicsVulkan(vkDevice_,
 									   vkQueue,
-									   vkCmdPool_,
+									   static_cast<uint32_t>(queueFamilyIndex_),
 									   vkPhysicalDevice,
-									   static_cast<int32_t>(swapBuffers.size()),
-									   addCommand,
+									   swapBufferCount,
+									   submissionQueue_,
 									   renderPassPipelineStateCache_,
+									   pipelineStateCache_,
 									   this);
 
+	graphics->SetPipelineCache(vkPipelineCache_);
+	graphics->SetTransferQueue(transferSubmissionQueue_, static_cast<uint32_t>(transferQueueFamilyIndex_));
+	graphics->SetComputeQueue(computeSubmissionQueue_, static_cast<uint32_t>(computeQueueFamilyIndex_));
+
 	return graphics;
 }
 
+bool PlatformVulkan::LoadPipelineCache(const char* path)
+{
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
+	if (!file)
+	{
+		return false;
+	}
+
+	const auto fileSize = static_cast<uint64_t>(file.tellg());
+	file.seekg(0, std::ios::beg);
+
+	PipelineCacheFileHeader header;
+	if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+	{
+		Log(LogType::Warning, std::string("A pipeline cache is broken : ") + path);
+		return false;
+	}
+
+	// a cache which is created by another device or driver is invalid
+	const auto expected = CreatePipelineCacheFileHeader(vkPhysicalDevice.getProperties(), header.DataSize);
+	if (memcmp(&header, &expected, sizeof(header)) != 0)
+	{
+		Log(LogType::Info, std::string("A pipeline cache is ignored because the device or the driver is changed : ") + path);
+		return false;
+	}
+
+	// a broken size must not allocate more than the file
+	if (static_cast<uint64_t>(header.DataSize) != fileSize - sizeof(header))
+	{
+		Log(LogType::Warning, std::string("A pipeline cache is broken : ") + path);
+		return false;
+	}
+
+	std::vector<uint8_t> data(static_cast<size_t>(header.DataSize));
+	if (!file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size())))
+	{
+		Log(LogType::Warning, std::string("A pipeline cache is broken : ") + path);
+		return false;
+	}
+
+	vk::PipelineCacheCreateInfo createInfo;
+	createInfo.initialDataSize = data.size();
+	createInfo.pInitialData = data.data();
+	auto loadedCache = vkDevice_.createPipelineCache(createInfo);
+	vkDevice_.mergePipelineCaches(vkPipelineCache_, loadedCache);
+	vkDevice_.destroyPipelineCache(loadedCache);
+	return true;
+}
+
+bool PlatformVulkan::SavePipelineCache(const char* path) const
+{
+	const auto data = vkDevice_.getPipelineCacheData(vkPipelineCache_);
+	const auto header = CreatePipelineCacheFileHeader(vkPhysicalDevice.getProperties(), data.size());
+
+	std::ofstream file(path, std::ios::binary);
+	if (!file)
+	{
+		Log(LogType::Error, std::string("Failed to open a file to save a pipeline cache : ") + path);
+		return false;
+	}
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+	if (!file)
+	{
+		Log(LogType::Error, std::string("Failed to save a pipeline cache : ") + path);
+		return false;
+	}
+
+	return true;
+}
+
 RenderPass* PlatformVulkan::GetCurrentScreen(const Color8& clearColor, bool isColorCleared, bool isDepthCleared)
 {
 	if (IsSwapchainValid())
@@ -4,6 +4,7 @@
 
 #include "../LLGI.Platform.h"
 #include "LLGI.BaseVulkan.h"
+#include <mutex>
 
 #ifdef _WIN32
 #include "../Win/LLGI.WindowWin.h"
@@ -14,6 +15,8 @@
 namespace LLGI
 {
 
+class SubmissionQueueVulkan;
+
 class PlatformVulkan : public Platform
 {
 private:
@@ -33,7 +36,6 @@ private:
 	public:
 		vk::Image image = nullptr;
 		vk::ImageView view = nullptr;
-		vk::Fence fence = nullptr;
 		TextureVulkan* texture = nullptr;
 	};
 
@@ -51,18 +53,47 @@ private:
 	vk::PhysicalDevice vkPhysicalDevice = nullptr;
 	vk::Device vkDevice_ = nullptr;
 	vk::PipelineCache vkPipelineCache_ = nullptr;
+	std::string pipelineCachePath_;
+	std::string pipelineManifestPath_;
 	vk::Queue vkQueue = nullptr;
 	vk::CommandPool vkCmdPool_ = nullptr;
 	int32_t queueFamilyIndex_ = 0;
 
+	//! collects submissions to the graphics queue, which are shared with Graphics
+	SubmissionQueueVulkan* submissionQueue_ = nullptr;
+
+	//! a queue for uploads which is shared by all graphics. it is null if a dedicated transfer queue family is not found
+	SubmissionQueueVulkan* transferSubmissionQueue_ = nullptr;
+	int32_t transferQueueFamilyIndex_ = 0;
+
+	//! a queue for asynchronous compute which is shared by all graphics. it is null if a dedicated compute queue family is not found
+	SubmissionQueueVulkan* computeSubmissionQueue_ = nullptr;
+	int32_t computeQueueFamilyIndex_ = 0;
+
+	bool isTimelineSemaphoreSupported_ = false;
+
 	Vec2I windowSize_;
 
-	//! to check to finish present
-	vk::Semaphore vkPresentComplete_;
+	struct FrameInFlight
+	{
+		//! to check to finish present
+		vk::Semaphore presentComplete;
+
+		//! to check to finish render
+		vk::Semaphore renderComplete;
 
-	//! to check to finish render
-	vk::Semaphore vkRenderComplete_;
-	std::vector<vk::CommandBuffer> vkCmdBuffers;
+		//! to change the layout of a swap buffer which is not rendered with the screen render pass
+		vk::CommandBuffer commandBuffer;
+
+		//! a value of the submission queue which is reached when the frame is finished
+		uint64_t submittedValue = 0;
+	};
+
+	std::vector<FrameInFlight> framesInFlight_;
+	int32_t currentFrameInFlight_ = 0;
+	int32_t acquireTimeout_ = -1;
+	bool isFrameSkipped_ = false;
+	bool isHeadless_ = false;
 
 	vk::SurfaceKHR surface_ = nullptr;
 	vk::SwapchainKHR swapchain_ = nullptr;
@@ -75,14 +106,13 @@ private:
 	TextureVulkan* depthStencilTexture_ = nullptr;
 
 	RenderPassPipelineStateCacheVulkan* renderPassPipelineStateCache_ = nullptr;
+	PipelineStateCacheVulkan* pipelineStateCache_ = nullptr;
 
 	std::vector<std::shared_ptr<RenderPassVulkan>> renderPasses_;
 	std::shared_ptr<RenderPassVulkan> dummyRenderPass_;
 
 	std::vector<SwapBuffer> swapBuffers;
 
-	int32_t executedCommandCount = 0;
-
 	Window* window_ = nullptr;
 
 #if !defined(NDEBUG)
@@ -100,17 +130,20 @@ private:
 	void CreateRenderPass();
 
 	/*!
-		@brief	get swap buffer index
+		@brief	acquire a swap buffer and update frameIndex
 		@param	semaphore	the signaling semaphore to be waited for other functions
+		@return	eTimeout, eNotReady or eErrorOutOfDateKHR if a swap buffer is not acquired
 	*/
-	uint32_t AcquireNextImage(vk::Semaphore& semaphore);
+	vk::Result AcquireNextImage(vk::Semaphore semaphore);
 
-	vk::Fence GetSubmitFence(bool destroy = false);
-
-	/**
-		@brief	the semaphore to wait for before present
+	/*!
+		@brief	wait until all queues on the device become idle and keep them idle while locks are held
+		@note
+		A device is not waited directly because queues may be used by graphics on other threads.
 	*/
-	vk::Result Present(vk::Semaphore semaphore);
+	std::vector<std::unique_lock<std::mutex>> LockIdleQueues();
+
+	void RecreateSwapChain();
 
 	// void SetImageBarrier(vk::CommandBuffer cmdbuffer,
 	//					vk::Image image,
@@ -130,12 +163,18 @@ public:
 	PlatformVulkan();
 	~PlatformVulkan() override;
 
-	bool Initialize(Window* window, bool waitVSync);
+	bool Initialize(Window* window, const PlatformParameter& parameter);
 
 	bool NewFrame() override;
 	void Present() override;
 	void SetWindowSize(const Vec2I& windowSize) override;
 
+	/**
+		@brief	create a graphics on the device of this platform
+		@note
+		It can be called from multiple threads. Graphics share queues and caches, but have their own command pools.
+		So graphics can be used on different threads as long as each graphics is used on one thread at a time.
+	*/
 	Graphics* CreateGraphics() override;
 
 	RenderPass* GetCurrentScreen(const Color8& clearColor, bool isColorCleared, bool isDepthCleared) override;
@@ -146,6 +185,19 @@ public:
 
 	vk::PipelineCache GetPipelineCache() const { return vkPipelineCache_; }
 
+	/**
+		@brief	merge a file which is saved with SavePipelineCache into the pipeline cache
+		@note
+		The file is ignored if it is saved on another device or driver.
+		It must not be called while pipeline states are compiled.
+	*/
+	bool LoadPipelineCache(const char* path);
+
+	/**
+		@brief	save the pipeline cache with the device and the driver version
+	*/
+	bool SavePipelineCache(const char* path) const;
+
 	vk::CommandPool GetCommandPool() const { return vkCmdPool_; }
 
 	vk::Queue GetQueue() const { return vkQueue; }
@@ -156,8 +208,16 @@ public:
 
 	int32_t GetQueueFamilyIndex() const { return queueFamilyIndex_; }
 
+	int32_t GetTransferQueueFamilyIndex() const { return transferQueueFamilyIndex_; }
+
+	int32_t GetComputeQueueFamilyIndex() const { return computeQueueFamilyIndex_; }
+
 	DeviceType GetDeviceType() const override { return DeviceType::Vulkan; }
 
+	bool GetIsFrameSkipped() const override { return isFrameSkipped_; }
+
+	bool GetIsHeadless() const { return isHeadless_; }
+
 	int GetMaxFrameCount() const override { return static_cast<int>(swapBufferCount); }
 };
 
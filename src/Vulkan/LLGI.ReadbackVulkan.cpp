@@ -0,0 +1,140 @@
+#include "LLGI.ReadbackVulkan.h"
+#include "LLGI.CommandListVulkan.h"
+#include "LLGI.GraphicsVulkan.h"
+
+namespace LLGI
+{
+
+ReadbackBufferPoolVulkan::ReadbackBufferPoolVulkan(GraphicsVulkan* graphics) : graphics_(graphics) {}
+
+ReadbackBufferPoolVulkan::~ReadbackBufferPoolVulkan()
+{
+	for (auto& block : freeBlocks_)
+	{
+		Destroy(block);
+	}
+	freeBlocks_.clear();
+}
+
+void ReadbackBufferPoolVulkan::Destroy(Block& block)
+{
+	if (block.mapped != nullptr)
+	{
+		vkUnmapMemory(static_cast<VkDevice>(graphics_->GetDevice()), block.buffer.GetNativeBufferMemory());
+		block.mapped = nullptr;
+	}
+
+	block.buffer.Dispose();
+}
+
+bool ReadbackBufferPoolVulkan::Acquire(VkDeviceSize size, Block& block)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		auto found = freeBlocks_.end();
+		for (auto it = freeBlocks_.begin(); it != freeBlocks_.end(); it++)
+		{
+			if (it->buffer.GetSize() >= size && (found == freeBlocks_.end() || it->buffer.GetSize() < found->buffer.GetSize()))
+			{
+				found = it;
+			}
+		}
+
+		if (found != freeBlocks_.end())
+		{
+			block = *found;
+			freeBlocks_.erase(found);
+			return true;
+		}
+	}
+
+	// round up to reuse blocks among similar sizes
+	VkDeviceSize blockSize = MinBlockSize;
+	while (blockSize < size)
+	{
+		blockSize *= 2;
+	}
+
+	Block newBlock;
+	if (!newBlock.buffer.Initialize(graphics_,
+									blockSize,
+									VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+									VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT))
+	{
+		Log(LogType::Error, "Failed to allocate a readback buffer.");
+		return false;
+	}
+
+	if (vkMapMemory(static_cast<VkDevice>(graphics_->GetDevice()),
+					newBlock.buffer.GetNativeBufferMemory(),
+					0,
+					newBlock.buffer.GetSize(),
+					0,
+					&newBlock.mapped) != VK_SUCCESS)
+	{
+		Log(LogType::Error, "Failed to map a readback buffer.");
+		Destroy(newBlock);
+		return false;
+	}
+
+	block = newBlock;
+	return true;
+}
+
+void ReadbackBufferPoolVulkan::Return(Block& block)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (freeBlocks_.size() < MaxFreeBlockCount)
+		{
+			freeBlocks_.push_back(block);
+			return;
+		}
+	}
+
+	Destroy(block);
+}
+
+ReadbackBufferVulkan::ReadbackBufferVulkan(GraphicsVulkan* graphics, const ReadbackBufferPoolVulkan::Block& block)
+	: graphics_(graphics), block_(block)
+{
+	SafeAddRef(graphics_);
+}
+
+ReadbackBufferVulkan::~ReadbackBufferVulkan()
+{
+	graphics_->GetReadbackBufferPool()->Return(block_);
+	SafeRelease(graphics_);
+}
+
+ReadbackTokenVulkan::ReadbackTokenVulkan(CommandListVulkan* commandList, ReadbackBufferVulkan* buffer, int32_t size, int32_t rowPitch)
+	: commandList_(commandList), buffer_(buffer), size_(size), rowPitch_(rowPitch)
+{
+	SafeAddRef(commandList_);
+	SafeAddRef(buffer_);
+	swapIndex_ = commandList_->GetCurrentSwapBufferIndex();
+	beginCount_ = commandList_->GetBeginCount();
+}
+
+ReadbackTokenVulkan::~ReadbackTokenVulkan()
+{
+	SafeRelease(buffer_);
+	SafeRelease(commandList_);
+}
+
+bool ReadbackTokenVulkan::IsReady() { return commandList_->IsCompleted(swapIndex_, beginCount_); }
+
+bool ReadbackTokenVulkan::Wait() { return commandList_->WaitUntilCompleted(swapIndex_, beginCount_); }
+
+const void* ReadbackTokenVulkan::GetData()
+{
+	if (!IsReady())
+	{
+		return nullptr;
+	}
+
+	return buffer_->GetData();
+}
+
+} // namespace LLGI
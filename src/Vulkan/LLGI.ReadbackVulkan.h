@@ -0,0 +1,82 @@
+#pragma once
+
+#include "../LLGI.CommandList.h"
+#include "LLGI.BaseVulkan.h"
+#include <mutex>
+
+namespace LLGI
+{
+
+class CommandListVulkan;
+
+/**
+	@brief	host visible buffers which are reused for copies from GPU to CPU
+	@note
+	Blocks are returned in any order because tokens are released by users, so freed blocks are kept in a list instead of a ring.
+*/
+class ReadbackBufferPoolVulkan
+{
+public:
+	struct Block
+	{
+		VulkanBuffer buffer;
+		void* mapped = nullptr;
+	};
+
+private:
+	static constexpr size_t MaxFreeBlockCount = 16;
+	static constexpr VkDeviceSize MinBlockSize = 64 * 1024;
+
+	GraphicsVulkan* graphics_ = nullptr;
+	std::mutex mutex_;
+	std::vector<Block> freeBlocks_;
+
+	void Destroy(Block& block);
+
+public:
+	ReadbackBufferPoolVulkan(GraphicsVulkan* graphics);
+	~ReadbackBufferPoolVulkan();
+
+	bool Acquire(VkDeviceSize size, Block& block);
+	void Return(Block& block);
+};
+
+/**
+	@brief	a block which is referenced by tokens and command lists while a copy is in flight
+*/
+class ReadbackBufferVulkan : public ReferenceObject
+{
+private:
+	GraphicsVulkan* graphics_ = nullptr;
+	ReadbackBufferPoolVulkan::Block block_;
+
+public:
+	ReadbackBufferVulkan(GraphicsVulkan* graphics, const ReadbackBufferPoolVulkan::Block& block);
+	~ReadbackBufferVulkan() override;
+
+	vk::Buffer GetBuffer() const { return static_cast<vk::Buffer>(block_.buffer.GetNativeBuffer()); }
+	const void* GetData() const { return block_.mapped; }
+};
+
+class ReadbackTokenVulkan : public ReadbackToken
+{
+private:
+	CommandListVulkan* commandList_ = nullptr;
+	ReadbackBufferVulkan* buffer_ = nullptr;
+	int32_t swapIndex_ = 0;
+	uint64_t beginCount_ = 0;
+	int32_t size_ = 0;
+	int32_t rowPitch_ = 0;
+
+public:
+	ReadbackTokenVulkan(CommandListVulkan* commandList, ReadbackBufferVulkan* buffer, int32_t size, int32_t rowPitch);
+	~ReadbackTokenVulkan() override;
+
+	bool IsReady() override;
+	bool Wait() override;
+	const void* GetData() override;
+	int32_t GetSize() const override { return size_; }
+	int32_t GetRowPitch() const override { return rowPitch_; }
+};
+
+} // namespace LLGI
@@ -17,6 +17,8 @@ RenderPassPipelineStateCacheVulkan::~RenderPassPipelineStateCacheVulkan()
 
 RenderPassPipelineStateVulkan* RenderPassPipelineStateCacheVulkan::Create(const RenderPassPipelineStateKey key)
 {
+	std::lock_guard<std::mutex> lock(mutex_);
+
 	// already?
 	{
 		auto it = renderPassPipelineStates_.find(key);
@@ -58,7 +60,8 @@ RenderPassPipelineStateVulkan* RenderPassPipelineStateCacheVulkan::Create(const
 		else
 			attachmentDescs.at(i).loadOp = vk::AttachmentLoadOp::eDontCare;
 
-		attachmentDescs.at(i).storeOp = vk::AttachmentStoreOp::eStore;
+		// transient attachments are not written back to memory
+		attachmentDescs.at(i).storeOp = key.IsColorTransient ? vk::AttachmentStoreOp::eDontCare : vk::AttachmentStoreOp::eStore;
 		attachmentDescs.at(i).stencilLoadOp = vk::AttachmentLoadOp::eDontCare;
 		attachmentDescs.at(i).stencilStoreOp = vk::AttachmentStoreOp::eDontCare;
 	}
@@ -69,6 +72,15 @@ RenderPassPipelineStateVulkan* RenderPassPipelineStateCacheVulkan::Create(const
 		attachmentDescs.at(0).initialLayout = (key.IsColorCleared) ? vk::ImageLayout::eUndefined : vk::ImageLayout::ePresentSrcKHR;
 		attachmentDescs.at(0).finalLayout = vk::ImageLayout::ePresentSrcKHR;
 	}
+	else if (key.IsColorTransient)
+	{
+		// transient attachments can't be sampled and their contents are never kept
+		for (int i = 0; i < colorCount; i++)
+		{
+			attachmentDescs.at(i).initialLayout = vk::ImageLayout::eUndefined;
+			attachmentDescs.at(i).finalLayout = vk::ImageLayout::eColorAttachmentOptimal;
+		}
+	}
 	else
 	{
 		for (int i = 0; i < colorCount; i++)
@@ -101,8 +113,9 @@ RenderPassPipelineStateVulkan* RenderPassPipelineStateCacheVulkan::Create(const
 		attachmentDescs.at(colorCount).stencilStoreOp = vk::AttachmentStoreOp::eDontCare;
 
 		// When clearing, the initialLayout does not matter.
-		attachmentDescs.at(colorCount).initialLayout =
-			(key.IsDepthCleared) ? vk::ImageLayout::eUndefined : vk::ImageLayout::eDepthStencilAttachmentOptimal;
+		attachmentDescs.at(colorCount).initialLayout = (key.IsDepthCleared || key.IsDepthTransient)
+														   ? vk::ImageLayout::eUndefined
+														   : vk::ImageLayout::eDepthStencilAttachmentOptimal;
 		attachmentDescs.at(colorCount).finalLayout = vk::ImageLayout::eDepthStencilAttachmentOptimal;
 		// attachmentDescs.at(colorCount).finalLayout = vk::ImageLayout::eDepthStencilReadOnlyOptimal;
 	}
@@ -227,6 +240,16 @@ RenderPassPipelineStateVulkan* RenderPassPipelineStateCacheVulkan::Create(const
 			dependencies[i * 2 + 1].dependencyFlags = (vk::DependencyFlags)VK_DEPENDENCY_BY_REGION_BIT;
 		}
 	}
+	else
+	{
+		// the layout transition from the presented image must wait for the acquire semaphore, which is waited at the color attachment output stage
+		dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+		dependencies[0].dstSubpass = 0;
+		dependencies[0].srcStageMask = (vk::PipelineStageFlags)VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+		dependencies[0].dstStageMask = (vk::PipelineStageFlags)VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+		dependencies[0].srcAccessMask = vk::AccessFlags();
+		dependencies[0].dstAccessMask = (vk::AccessFlags)VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	}
 
 	{
 		vk::RenderPassCreateInfo renderPassInfo;
@@ -243,8 +266,8 @@ RenderPassPipelineStateVulkan* RenderPassPipelineStateCacheVulkan::Create(const
 		}
 		else
 		{
-			renderPassInfo.dependencyCount = 0;
-			renderPassInfo.pDependencies = nullptr;
+			renderPassInfo.dependencyCount = 1;
+			renderPassInfo.pDependencies = dependencies.data();
 		}
 
 		auto renderPass = device_.createRenderPass(renderPassInfo);
@@ -5,6 +5,7 @@
 #include "LLGI.BaseVulkan.h"
 #include "LLGI.RenderPassVulkan.h"
 #include <functional>
+#include <mutex>
 #include <unordered_map>
 
 namespace LLGI
@@ -19,6 +20,9 @@ private:
 	vk::Device device_;
 	ReferenceObject* owner_ = nullptr;
 
+	//! it is shared by graphics which are used on different threads
+	std::mutex mutex_;
+
 public:
 	RenderPassPipelineStateCacheVulkan(vk::Device device, ReferenceObject* owner);
 	~RenderPassPipelineStateCacheVulkan() override;
@@ -3,16 +3,83 @@
 namespace LLGI
 {
 
-ShaderVulkan::ShaderVulkan() {}
+namespace
+{
 
-ShaderVulkan::~ShaderVulkan()
+const uint32_t SpirvMagicNumber = 0x07230203;
+const uint32_t SpirvHeaderWordCount = 5;
+const uint32_t SpirvOpDecorate = 71;
+const uint32_t SpirvDecorationBinding = 33;
+const uint32_t SpirvDecorationDescriptorSet = 34;
+
+/**
+	@brief	get bindings which are declared in each descriptor set (constant buffers, textures and compute buffers)
+	@note
+	Only decorations are read because spirv-cross is not linked to the runtime.
+*/
+std::array<uint32_t, 3> ReflectBindingMasks(const std::vector<uint32_t>& words)
 {
-	if (shaderModule_)
+	std::array<uint32_t, 3> bindingMasks;
+	bindingMasks.fill(~0u);
+
+	if (words.size() < SpirvHeaderWordCount || words[0] != SpirvMagicNumber)
+	{
+		Log(LogType::Warning, "Bindings of a shader are not reflected because it is not SPIR-V.");
+		return bindingMasks;
+	}
+
+	std::unordered_map<uint32_t, uint32_t> sets;
+	std::unordered_map<uint32_t, uint32_t> bindings;
+
+	for (size_t i = SpirvHeaderWordCount; i < words.size();)
 	{
-		graphics_->GetDevice().destroyShaderModule(shaderModule_);
-		shaderModule_ = nullptr;
+		const auto instructionWordCount = words[i] >> 16;
+		const auto opcode = words[i] & 0xFFFF;
+
+		if (instructionWordCount == 0 || i + instructionWordCount > words.size())
+		{
+			Log(LogType::Warning, "Bindings of a shader are not reflected because SPIR-V is broken.");
+			return bindingMasks;
+		}
+
+		if (opcode == SpirvOpDecorate && instructionWordCount >= 4)
+		{
+			if (words[i + 2] == SpirvDecorationDescriptorSet)
+			{
+				sets[words[i + 1]] = words[i + 3];
+			}
+			else if (words[i + 2] == SpirvDecorationBinding)
+			{
+				bindings[words[i + 1]] = words[i + 3];
+			}
+		}
+
+		i += instructionWordCount;
+	}
+
+	bindingMasks.fill(0);
+
+	for (const auto& binding : bindings)
+	{
+		auto it = sets.find(binding.first);
+		if (it == sets.end() || it->second >= bindingMasks.size() || binding.second >= 32)
+		{
+			continue;
+		}
+
+		bindingMasks[it->second] |= 1u << binding.second;
 	}
 
+	return bindingMasks;
+}
+
+} // namespace
+
+ShaderVulkan::ShaderVulkan() {}
+
+ShaderVulkan::~ShaderVulkan()
+{
+	shaderModule_.reset();
 	SafeRelease(graphics_);
 }
 
@@ -23,22 +90,50 @@ bool ShaderVulkan::Initialize(GraphicsVulkan* graphics, DataStructure* data, int
 	if (data[0].Size == 0)
 		return false;
 
-	buffer.resize(data[0].Size);
-	memcpy(buffer.data(), data[0].Data, data[0].Size);
+	const auto code = static_cast<const uint8_t*>(data[0].Data);
+	const auto codeSize = static_cast<size_t>(data[0].Size);
+
+	// FNV-1a
+	hash_ = 14695981039346656037ULL;
+	for (size_t i = 0; i < codeSize; i++)
+	{
+		hash_ ^= code[i];
+		hash_ *= 1099511628211ULL;
+	}
+	codeSize_ = codeSize;
 
 	SafeAddRef(graphics);
 	SafeRelease(graphics_);
 	graphics_ = graphics;
 
+	// reuse a module which is created from the same code
+	auto pipelineStateCache = graphics_->GetPipelineStateCache();
+
+	shaderModule_ = pipelineStateCache->FindShaderModule(hash_, codeSize);
+	if (shaderModule_ != nullptr)
+	{
+		return true;
+	}
+
+	// a copy is aligned for words and freed after the module is created
+	std::vector<uint32_t> words((codeSize + sizeof(uint32_t) - 1) / sizeof(uint32_t), 0);
+	memcpy(words.data(), code, codeSize);
+
+	auto shaderModule = std::make_shared<ShaderModuleVulkan>(graphics_->GetDevice());
+	shaderModule->CodeSize = codeSize;
+	shaderModule->BindingMasks = ReflectBindingMasks(words);
+
 	vk::ShaderModuleCreateInfo info;
-	info.pCode = reinterpret_cast<const uint32_t*>(buffer.data());
-	info.codeSize = buffer.size();
+	info.pCode = words.data();
+	info.codeSize = codeSize;
+
+	shaderModule->ShaderModule = graphics_->GetDevice().createShaderModule(info);
 
-	shaderModule_ = graphics_->GetDevice().createShaderModule(info);
+	shaderModule_ = pipelineStateCache->RegisterShaderModule(hash_, shaderModule);
 
 	return true;
 }
 
-vk::ShaderModule ShaderVulkan::GetShaderModule() const { return shaderModule_; }
+vk::ShaderModule ShaderVulkan::GetShaderModule() const { return shaderModule_->ShaderModule; }
 
 } // namespace LLGI
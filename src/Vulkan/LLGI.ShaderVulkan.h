@@ -4,6 +4,7 @@
 #include "../LLGI.Shader.h"
 #include "LLGI.BaseVulkan.h"
 #include "LLGI.GraphicsVulkan.h"
+#include "LLGI.PipelineStateCacheVulkan.h"
 
 namespace LLGI
 {
@@ -12,8 +13,11 @@ class ShaderVulkan : public Shader
 {
 private:
 	GraphicsVulkan* graphics_ = nullptr;
-	std::vector<uint8_t> buffer;
-	vk::ShaderModule shaderModule_;
+	uint64_t hash_ = 0;
+	uint64_t codeSize_ = 0;
+
+	//! shared by shaders with the same code
+	std::shared_ptr<ShaderModuleVulkan> shaderModule_;
 
 public:
 	ShaderVulkan();
@@ -22,6 +26,21 @@ public:
 	bool Initialize(GraphicsVulkan* graphics, DataStructure* data, int count);
 
 	vk::ShaderModule GetShaderModule() const;
+
+	/**
+		@brief	a hash of SPIR-V which identifies shaders with the same code
+	*/
+	uint64_t GetHash() const { return hash_; }
+
+	//! compared in addition to a hash because a hash may collide
+	uint64_t GetCodeSize() const { return codeSize_; }
+
+	/**
+		@brief	get bindings which are declared in each descriptor set
+		@note
+		A bit is set for each binding. All bits are set if SPIR-V cannot be parsed.
+	*/
+	const std::array<uint32_t, 3>& GetBindingMasks() const { return shaderModule_->BindingMasks; }
 };
 
 } // namespace LLGI
@@ -0,0 +1,562 @@
+#include "LLGI.SubmissionQueueVulkan.h"
+#include <algorithm>
+
+namespace LLGI
+{
+
+SubmissionQueueVulkan::~SubmissionQueueVulkan()
+{
+	if (!device_)
+	{
+		return;
+	}
+
+	WaitIdle();
+
+	if (thread_.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> lock(threadMutex_);
+			isThreadStopped_ = true;
+		}
+		threadCondition_.notify_all();
+		thread_.join();
+	}
+
+	for (auto& inFlight : inFlightFences_)
+	{
+		device_.destroyFence(inFlight.fence);
+	}
+	inFlightFences_.clear();
+
+	for (auto& fence : freeFences_)
+	{
+		device_.destroyFence(fence);
+	}
+	freeFences_.clear();
+
+	// no thread waits fences when the queue is destroyed
+	for (auto& fence : retiredFences_)
+	{
+		device_.destroyFence(fence);
+	}
+	retiredFences_.clear();
+
+	if (timeline_)
+	{
+		device_.destroySemaphore(timeline_);
+		timeline_ = nullptr;
+	}
+}
+
+bool SubmissionQueueVulkan::Initialize(vk::Device device, vk::Queue queue, bool isTimelineSemaphoreEnabled, bool isThreadEnabled)
+{
+	device_ = device;
+	queue_ = queue;
+
+	if (isTimelineSemaphoreEnabled)
+	{
+		// functions of the extension are not exported from the loader
+		getSemaphoreCounterValue_ =
+			reinterpret_cast<PFN_vkGetSemaphoreCounterValueKHR>(device_.getProcAddr("vkGetSemaphoreCounterValueKHR"));
+		waitSemaphores_ = reinterpret_cast<PFN_vkWaitSemaphoresKHR>(device_.getProcAddr("vkWaitSemaphoresKHR"));
+
+		if (getSemaphoreCounterValue_ != nullptr && waitSemaphores_ != nullptr)
+		{
+			vk::SemaphoreTypeCreateInfo semaphoreTypeInfo;
+			semaphoreTypeInfo.semaphoreType = vk::SemaphoreType::eTimeline;
+			semaphoreTypeInfo.initialValue = 0;
+
+			vk::SemaphoreCreateInfo semaphoreInfo;
+			semaphoreInfo.pNext = &semaphoreTypeInfo;
+			timeline_ = device_.createSemaphore(semaphoreInfo);
+		}
+		else
+		{
+			Log(LogType::Warning, "Timeline semaphores are not available. Fences are used instead.");
+		}
+	}
+
+	if (isThreadEnabled)
+	{
+		isThreadEnabled_ = true;
+		thread_ = std::thread([this]() { RunThread(); });
+	}
+
+	return true;
+}
+
+uint64_t SubmissionQueueVulkan::Add(vk::CommandBuffer commandBuffer,
+									const std::vector<SemaphoreOperation>& waits,
+									const std::vector<SemaphoreOperation>& signals)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	// signals must not wait command buffers which are added after.
+	// waits are applied to the whole group because a semaphore wait doesn't block later batches in the same vkQueueSubmit
+	if (pendingGroups_.empty() || !pendingGroups_.back().signals.empty())
+	{
+		pendingGroups_.emplace_back();
+	}
+
+	auto& group = pendingGroups_.back();
+	group.waits.insert(group.waits.end(), waits.begin(), waits.end());
+
+	if (commandBuffer)
+	{
+		group.commandBuffers.push_back(commandBuffer);
+	}
+
+	group.signals = signals;
+
+	return submittedValue_ + 1;
+}
+
+std::unique_lock<std::mutex> SubmissionQueueVulkan::LockWithTaskSpace(size_t taskCount)
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+
+	// tasks are pushed only with the lock, so space which is found with the lock is kept until it is released
+	while (isThreadEnabled_ && tasks_.GetFreeCount() < taskCount)
+	{
+		lock.unlock();
+
+		{
+			// the frame thread blocks only when it is too far ahead of the submission thread
+			std::unique_lock<std::mutex> threadLock(threadMutex_);
+			threadCondition_.wait(threadLock, [this, taskCount]() { return tasks_.GetFreeCount() >= taskCount; });
+		}
+
+		lock.lock();
+	}
+
+	return lock;
+}
+
+bool SubmissionQueueVulkan::Flush()
+{
+	auto lock = LockWithTaskSpace();
+	return FlushWithoutLock();
+}
+
+bool SubmissionQueueVulkan::FlushSynchronously()
+{
+	auto lock = LockWithTaskSpace();
+	if (!FlushWithoutLock())
+	{
+		return false;
+	}
+
+	WaitTasks();
+	return true;
+}
+
+bool SubmissionQueueVulkan::FlushWithoutLock()
+{
+	if (pendingGroups_.empty())
+	{
+		return true;
+	}
+
+	Task task;
+	task.value = submittedValue_ + 1;
+
+	// a signal operation of vkQueueSubmit includes all commands which are submitted before, so only the last group signals the value
+	if (timeline_)
+	{
+		SemaphoreOperation signal;
+		signal.Semaphore = timeline_;
+		signal.Value = task.value;
+		pendingGroups_.back().signals.push_back(signal);
+	}
+	else if (freeFences_.empty())
+	{
+		task.fence = device_.createFence(vk::FenceCreateInfo());
+	}
+	else
+	{
+		task.fence = freeFences_.back();
+		freeFences_.pop_back();
+	}
+
+	task.groups.swap(pendingGroups_);
+
+	// a fence and a timeline can be waited before they are submitted, so the value is treated as submitted when it is pushed.
+	// the value is reached even if commands fail to be submitted, because it is already returned by Add
+	const auto isSubmitted = isThreadEnabled_ || SubmitOrSignal(task);
+
+	submittedValue_ = task.value;
+
+	if (task.fence)
+	{
+		InFlightFence inFlight;
+		inFlight.fence = task.fence;
+		inFlight.value = task.value;
+		inFlightFences_.push_back(inFlight);
+	}
+
+	if (isThreadEnabled_)
+	{
+		PushTask(task);
+	}
+
+	return isSubmitted;
+}
+
+bool SubmissionQueueVulkan::Submit(Task& task)
+{
+	const auto groupCount = task.groups.size();
+	std::vector<vk::SubmitInfo> submitInfos(groupCount);
+	std::vector<vk::TimelineSemaphoreSubmitInfo> timelineInfos(groupCount);
+	std::vector<std::vector<vk::Semaphore>> waitSemaphores(groupCount);
+	std::vector<std::vector<uint64_t>> waitValues(groupCount);
+	std::vector<std::vector<vk::PipelineStageFlags>> waitStages(groupCount);
+	std::vector<std::vector<vk::Semaphore>> signalSemaphores(groupCount);
+	std::vector<std::vector<uint64_t>> signalValues(groupCount);
+
+	for (size_t i = 0; i < groupCount; i++)
+	{
+		const auto& group = task.groups[i];
+
+		for (const auto& wait : group.waits)
+		{
+			waitSemaphores[i].push_back(wait.Semaphore);
+			waitValues[i].push_back(wait.Value);
+			waitStages[i].push_back(wait.Stage);
+		}
+
+		for (const auto& signal : group.signals)
+		{
+			signalSemaphores[i].push_back(signal.Semaphore);
+			signalValues[i].push_back(signal.Value);
+		}
+
+		auto& submitInfo = submitInfos[i];
+		submitInfo.waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores[i].size());
+		submitInfo.pWaitSemaphores = waitSemaphores[i].data();
+		submitInfo.pWaitDstStageMask = waitStages[i].data();
+		submitInfo.commandBufferCount = static_cast<uint32_t>(group.commandBuffers.size());
+		submitInfo.pCommandBuffers = group.commandBuffers.data();
+		submitInfo.signalSemaphoreCount = static_cast<uint32_t>(signalSemaphores[i].size());
+		submitInfo.pSignalSemaphores = signalSemaphores[i].data();
+
+		if (timeline_)
+		{
+			auto& timelineInfo = timelineInfos[i];
+			timelineInfo.waitSemaphoreValueCount = static_cast<uint32_t>(waitValues[i].size());
+			timelineInfo.pWaitSemaphoreValues = waitValues[i].data();
+			timelineInfo.signalSemaphoreValueCount = static_cast<uint32_t>(signalValues[i].size());
+			timelineInfo.pSignalSemaphoreValues = signalValues[i].data();
+			submitInfo.pNext = &timelineInfo;
+		}
+	}
+
+	const auto submitResult = queue_.submit(static_cast<uint32_t>(submitInfos.size()), submitInfos.data(), task.fence);
+	if (submitResult != vk::Result::eSuccess)
+	{
+		Log(LogType::Error, "Failed to submit");
+		return false;
+	}
+
+	return true;
+}
+
+bool SubmissionQueueVulkan::SubmitOrSignal(Task& task)
+{
+	if (Submit(task))
+	{
+		return true;
+	}
+
+	Task signalTask;
+	signalTask.fence = task.fence;
+
+	if (timeline_)
+	{
+		SemaphoreOperation signal;
+		signal.Semaphore = timeline_;
+		signal.Value = task.value;
+
+		signalTask.groups.emplace_back();
+		signalTask.groups.back().signals.push_back(signal);
+	}
+
+	if (!Submit(signalTask))
+	{
+		Log(LogType::Error, "Failed to signal a value whose commands are not submitted.");
+	}
+
+	return false;
+}
+
+vk::Result SubmissionQueueVulkan::Present(vk::SwapchainKHR swapchain, uint32_t imageIndex, vk::Semaphore waitSemaphore)
+{
+	Task task;
+	task.swapchain = swapchain;
+	task.imageIndex = imageIndex;
+	task.presentWait = waitSemaphore;
+
+	// a flush and a present
+	auto lock = LockWithTaskSpace(2);
+
+	// the semaphore to wait must be signaled by a submission before
+	FlushWithoutLock();
+
+	if (!isThreadEnabled_)
+	{
+		return PresentTask(task);
+	}
+
+	PushTask(task);
+
+	std::lock_guard<std::mutex> presentLock(presentMutex_);
+	const auto result = lastPresentResult_;
+	lastPresentResult_ = vk::Result::eSuccess;
+	return result;
+}
+
+vk::Result SubmissionQueueVulkan::PresentTask(Task& task)
+{
+	vk::PresentInfoKHR presentInfo;
+	presentInfo.swapchainCount = 1;
+	presentInfo.pSwapchains = &task.swapchain;
+	presentInfo.pImageIndices = &task.imageIndex;
+	presentInfo.waitSemaphoreCount = task.presentWait ? 1 : 0;
+	presentInfo.pWaitSemaphores = &task.presentWait;
+
+	try
+	{
+		return queue_.presentKHR(presentInfo);
+	}
+	catch (const vk::OutOfDateKHRError&)
+	{
+		return vk::Result::eErrorOutOfDateKHR;
+	}
+}
+
+void SubmissionQueueVulkan::PushTask(Task& task)
+{
+	// space is kept by LockWithTaskSpace, so it doesn't fail
+	tasks_.Push(task);
+
+	{
+		std::lock_guard<std::mutex> lock(threadMutex_);
+		pushedTaskCount_++;
+	}
+	threadCondition_.notify_all();
+}
+
+void SubmissionQueueVulkan::WaitTasks()
+{
+	if (!isThreadEnabled_)
+	{
+		return;
+	}
+
+	std::unique_lock<std::mutex> lock(threadMutex_);
+	threadCondition_.wait(lock, [this]() { return processedTaskCount_ == pushedTaskCount_; });
+}
+
+void SubmissionQueueVulkan::RunThread()
+{
+	Task task;
+
+	while (true)
+	{
+		if (!tasks_.Pop(task))
+		{
+			std::unique_lock<std::mutex> lock(threadMutex_);
+			threadCondition_.wait(lock, [this]() { return !tasks_.IsEmpty() || isThreadStopped_; });
+
+			if (tasks_.IsEmpty() && isThreadStopped_)
+			{
+				return;
+			}
+
+			continue;
+		}
+
+		if (task.swapchain)
+		{
+			std::lock_guard<std::mutex> lock(presentMutex_);
+			const auto result = PresentTask(task);
+			if (result != vk::Result::eSuccess)
+			{
+				lastPresentResult_ = result;
+			}
+		}
+		else
+		{
+			SubmitOrSignal(task);
+		}
+
+		task = Task();
+
+		{
+			std::lock_guard<std::mutex> lock(threadMutex_);
+			processedTaskCount_++;
+		}
+		threadCondition_.notify_all();
+	}
+}
+
+void SubmissionQueueVulkan::UpdateCompletedValue()
+{
+	if (timeline_)
+	{
+		uint64_t value = 0;
+		if (getSemaphoreCounterValue_(static_cast<VkDevice>(device_), static_cast<VkSemaphore>(timeline_), &value) == VK_SUCCESS)
+		{
+			completedValue_ = value;
+		}
+		return;
+	}
+
+	// fences are signaled in the submitted order
+	size_t completedCount = 0;
+	for (auto& inFlight : inFlightFences_)
+	{
+		if (device_.getFenceStatus(inFlight.fence) != vk::Result::eSuccess)
+		{
+			break;
+		}
+
+		completedValue_ = inFlight.value;
+		completedCount++;
+
+		// a fence which is waited without the lock is reset after the waiter returns
+		if (std::find(waitedFences_.begin(), waitedFences_.end(), inFlight.fence) != waitedFences_.end())
+		{
+			retiredFences_.push_back(inFlight.fence);
+			continue;
+		}
+
+		device_.resetFences(inFlight.fence);
+		freeFences_.push_back(inFlight.fence);
+	}
+
+	inFlightFences_.erase(inFlightFences_.begin(), inFlightFences_.begin() + completedCount);
+}
+
+bool SubmissionQueueVulkan::IsCompleted(uint64_t value)
+{
+	auto lock = LockWithTaskSpace();
+
+	if (value <= completedValue_)
+	{
+		return true;
+	}
+
+	// polling must not wait forever for commands which are not submitted
+	if (value > submittedValue_)
+	{
+		FlushWithoutLock();
+		return false;
+	}
+
+	UpdateCompletedValue();
+	return value <= completedValue_;
+}
+
+bool SubmissionQueueVulkan::Wait(uint64_t value)
+{
+	auto lock = LockWithTaskSpace();
+
+	if (value <= completedValue_)
+	{
+		return true;
+	}
+
+	if (value > submittedValue_ && !FlushWithoutLock())
+	{
+		return false;
+	}
+
+	if (value > submittedValue_)
+	{
+		Log(LogType::Error, "Wait : the value is not added.");
+		return false;
+	}
+
+	if (timeline_)
+	{
+		// other threads can add commands while waiting
+		auto timeline = static_cast<VkSemaphore>(timeline_);
+		lock.unlock();
+
+		VkSemaphoreWaitInfo waitInfo = {};
+		waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+		waitInfo.semaphoreCount = 1;
+		waitInfo.pSemaphores = &timeline;
+		waitInfo.pValues = &value;
+
+		if (waitSemaphores_(static_cast<VkDevice>(device_), &waitInfo, UINT64_MAX) != VK_SUCCESS)
+		{
+			Log(LogType::Error, "Failed to wait a timeline semaphore.");
+			return false;
+		}
+
+		lock.lock();
+		completedValue_ = std::max(completedValue_, value);
+		return true;
+	}
+
+	auto inFlight = std::find_if(
+		inFlightFences_.begin(), inFlightFences_.end(), [value](const InFlightFence& f) { return f.value >= value; });
+
+	if (inFlight != inFlightFences_.end())
+	{
+		// other threads can add commands while waiting, but the fence must not be reset until it returns
+		const auto fence = inFlight->fence;
+		waitedFences_.push_back(fence);
+		lock.unlock();
+
+		const auto result = device_.waitForFences(fence, VK_TRUE, UINT64_MAX);
+
+		lock.lock();
+		waitedFences_.erase(std::find(waitedFences_.begin(), waitedFences_.end(), fence));
+
+		auto retired = std::find(retiredFences_.begin(), retiredFences_.end(), fence);
+		if (retired != retiredFences_.end() && std::find(waitedFences_.begin(), waitedFences_.end(), fence) == waitedFences_.end())
+		{
+			retiredFences_.erase(retired);
+			device_.resetFences(fence);
+			freeFences_.push_back(fence);
+		}
+
+		if (result != vk::Result::eSuccess)
+		{
+			Log(LogType::Error, "Failed to wait a fence.");
+			return false;
+		}
+	}
+
+	UpdateCompletedValue();
+	return value <= completedValue_;
+}
+
+void SubmissionQueueVulkan::WaitIdle()
+{
+	auto lock = LockWithTaskSpace();
+	FlushWithoutLock();
+
+	// the queue must not be used by the submission thread while it is waited
+	WaitTasks();
+
+	queue_.waitIdle();
+	UpdateCompletedValue();
+}
+
+std::unique_lock<std::mutex> SubmissionQueueVulkan::LockIdle()
+{
+	auto lock = LockWithTaskSpace();
+	FlushWithoutLock();
+	WaitTasks();
+
+	queue_.waitIdle();
+	UpdateCompletedValue();
+
+	return lock;
+}
+
+} // namespace LLGI
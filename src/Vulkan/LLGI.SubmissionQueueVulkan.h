@@ -0,0 +1,188 @@
+#pragma once
+
+#include "../Utils/LLGI.LockFreeQueue.h"
+#include "LLGI.BaseVulkan.h"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace LLGI
+{
+
+/**
+	@brief	a queue which collects command buffers and submits them with one vkQueueSubmit
+	@note
+	Each flush signals a monotonically increasing value. Submitted commands are tracked by the value instead of fences.
+	A timeline semaphore is used if it is supported. Otherwise, a fence is reused for each flush.
+	If a submission thread is enabled, vkQueueSubmit and vkQueuePresentKHR are called on it and flushes don't wait for the driver.
+	In this case, the queue must not be used directly without WaitIdle.
+*/
+class SubmissionQueueVulkan : public ReferenceObject
+{
+public:
+	struct SemaphoreOperation
+	{
+		vk::Semaphore Semaphore;
+
+		//! ignored for binary semaphores
+		uint64_t Value = 0;
+
+		//! ignored for signal operations
+		vk::PipelineStageFlags Stage = vk::PipelineStageFlagBits::eAllCommands;
+	};
+
+private:
+	struct Group
+	{
+		std::vector<SemaphoreOperation> waits;
+		std::vector<vk::CommandBuffer> commandBuffers;
+		std::vector<SemaphoreOperation> signals;
+	};
+
+	struct InFlightFence
+	{
+		vk::Fence fence;
+		uint64_t value = 0;
+	};
+
+	//! a flush or a present which is processed on the submission thread
+	struct Task
+	{
+		std::vector<Group> groups;
+		vk::Fence fence;
+		uint64_t value = 0;
+
+		vk::SwapchainKHR swapchain;
+		uint32_t imageIndex = 0;
+		vk::Semaphore presentWait;
+	};
+
+	static constexpr size_t TaskCountMax = 16;
+
+	vk::Device device_;
+	vk::Queue queue_;
+
+	std::mutex mutex_;
+	std::vector<Group> pendingGroups_;
+	uint64_t submittedValue_ = 0;
+	uint64_t completedValue_ = 0;
+
+	vk::Semaphore timeline_;
+	PFN_vkGetSemaphoreCounterValueKHR getSemaphoreCounterValue_ = nullptr;
+	PFN_vkWaitSemaphoresKHR waitSemaphores_ = nullptr;
+
+	std::vector<InFlightFence> inFlightFences_;
+	std::vector<vk::Fence> freeFences_;
+
+	//! fences which are waited without the lock. A fence is added for each waiter.
+	std::vector<vk::Fence> waitedFences_;
+
+	//! fences which are completed while they are waited. they are reset by the last waiter.
+	std::vector<vk::Fence> retiredFences_;
+
+	bool isThreadEnabled_ = false;
+	std::thread thread_;
+	LockFreeQueue<Task, TaskCountMax> tasks_;
+
+	//! used only to sleep and wake up threads. tasks are passed without it.
+	std::mutex threadMutex_;
+	std::condition_variable threadCondition_;
+	uint64_t pushedTaskCount_ = 0;
+	uint64_t processedTaskCount_ = 0;
+	bool isThreadStopped_ = false;
+
+	//! a swapchain must not be used while it is presented
+	std::mutex presentMutex_;
+	vk::Result lastPresentResult_ = vk::Result::eSuccess;
+
+	//! lock the queue after the submission thread has space for tasks, so the lock is not held while the thread is waited
+	std::unique_lock<std::mutex> LockWithTaskSpace(size_t taskCount = 1);
+
+	bool FlushWithoutLock();
+	void UpdateCompletedValue();
+
+	bool Submit(Task& task);
+
+	//! submit a task, or signal its value without commands if it fails, otherwise waits never finish
+	bool SubmitOrSignal(Task& task);
+	vk::Result PresentTask(Task& task);
+	void PushTask(Task& task);
+	void WaitTasks();
+	void RunThread();
+
+public:
+	SubmissionQueueVulkan() = default;
+	~SubmissionQueueVulkan() override;
+
+	/**
+		@param	isTimelineSemaphoreEnabled	whether VK_KHR_timeline_semaphore is enabled on the device
+		@param	isThreadEnabled	whether submissions are processed on a dedicated thread
+	*/
+	bool Initialize(vk::Device device, vk::Queue queue, bool isTimelineSemaphoreEnabled, bool isThreadEnabled = false);
+
+	/**
+		@brief	add a command buffer which is submitted in the next flush
+		@param	commandBuffer	it can be null to add only semaphore operations
+		@param	waits	they are waited by command buffers which are added before the next signal, including ones which are already added
+		@return	a value which is reached when the command buffer is finished
+	*/
+	uint64_t Add(vk::CommandBuffer commandBuffer,
+				 const std::vector<SemaphoreOperation>& waits = {},
+				 const std::vector<SemaphoreOperation>& signals = {});
+
+	/**
+		@brief	submit all added command buffers
+	*/
+	bool Flush();
+
+	/**
+		@brief	submit all added command buffers and return after vkQueueSubmit is called even if the submission thread is enabled
+		@note
+		Command buffers which are submitted into the queue directly after it are executed after them.
+	*/
+	bool FlushSynchronously();
+
+	/**
+		@brief	present a swap buffer after command buffers which are flushed
+		@return	a result of vkQueuePresentKHR. If the submission thread is enabled, a result of the previous present is returned.
+	*/
+	vk::Result Present(vk::SwapchainKHR swapchain, uint32_t imageIndex, vk::Semaphore waitSemaphore);
+
+	/**
+		@brief	lock it while the swapchain is used except Present, for example vkAcquireNextImageKHR
+	*/
+	std::mutex& GetPresentMutex() { return presentMutex_; }
+
+	/**
+		@brief	whether commands until the value are finished. It doesn't block.
+		@note
+		Added command buffers are submitted if the value is not submitted yet.
+	*/
+	bool IsCompleted(uint64_t value);
+
+	/**
+		@brief	wait until commands until the value are finished. Added command buffers are submitted if it is required.
+	*/
+	bool Wait(uint64_t value);
+
+	/**
+		@brief	submit all added command buffers and wait until the queue becomes idle
+		@note
+		The queue can be used directly after it until a next flush.
+	*/
+	void WaitIdle();
+
+	/**
+		@brief	submit all added command buffers, wait until the queue becomes idle and keep it idle while the lock is held
+		@note
+		Other threads which use the queue are blocked until the lock is released.
+	*/
+	std::unique_lock<std::mutex> LockIdle();
+
+	vk::Queue GetQueue() const { return queue_; }
+
+	//! null if timeline semaphores are not supported
+	vk::Semaphore GetTimeline() const { return timeline_; }
+};
+
+} // namespace LLGI
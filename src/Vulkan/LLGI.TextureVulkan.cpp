@@ -1,5 +1,6 @@
 
 #include "LLGI.TextureVulkan.h"
+#include "LLGI.SubmissionQueueVulkan.h"
 
 namespace LLGI
 {
@@ -18,6 +19,11 @@ TextureVulkan::TextureVulkan() {}
 
 TextureVulkan::~TextureVulkan()
 {
+	if (graphics_ != nullptr)
+	{
+		graphics_->UnregisterInitialLayoutTransition(this);
+	}
+
 	if (view_ && type_ != TextureType::Screen)
 	{
 		device_.destroyImageView(view_);
@@ -54,6 +60,7 @@ bool TextureVulkan::Initialize(GraphicsVulkan* graphics,
 	graphics_ = graphics;
 
 	parameter_ = parameter;
+	usage_ = parameter.Usage;
 
 	type_ = TextureType::Color;
 	vk::ImageType dimension = vk::ImageType::e2D;
@@ -74,6 +81,19 @@ bool TextureVulkan::Initialize(GraphicsVulkan* graphics,
 
 	vk::ImageAspectFlags aspect = {};
 
+	const auto isTransient = (parameter.Usage & TextureUsageType::Transient) != TextureUsageType::NoneFlag;
+
+	if (isTransient && !IsDepthFormat(parameter.Format) && (parameter.Usage & TextureUsageType::RenderTarget) == TextureUsageType::NoneFlag)
+	{
+		Log(LogType::Error, "Transient texture must be a render target or a depth texture.");
+		return false;
+	}
+
+	if (isTransient)
+	{
+		resourceUsage = resourceUsage | vk::ImageUsageFlagBits::eTransientAttachment;
+	}
+
 	if (IsDepthFormat(parameter.Format))
 	{
 		resourceUsage = resourceUsage | vk::ImageUsageFlagBits::eDepthStencilAttachment;
@@ -97,8 +117,12 @@ bool TextureVulkan::Initialize(GraphicsVulkan* graphics,
 	{
 		aspect = vk::ImageAspectFlagBits::eColor;
 
-		resourceUsage =
-			resourceUsage | vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eSampled;
+		// a transient attachment can have only attachment usages
+		if (!isTransient)
+		{
+			resourceUsage = resourceUsage | vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eTransferSrc |
+							vk::ImageUsageFlagBits::eSampled;
+		}
 	}
 
 	if ((parameter.Usage & TextureUsageType::RenderTarget) != TextureUsageType::NoneFlag)
@@ -143,7 +167,7 @@ bool TextureVulkan::Initialize(GraphicsVulkan* graphics,
 	memorySize = GetTextureMemorySize(format_, parameter.Size);
 
 	// create a buffer on cpu
-	if (!IsDepthFormat(parameter.Format))
+	if (!IsDepthFormat(parameter.Format) && !isTransient)
 	{
 		cpuBuf = std::unique_ptr<InternalBuffer>(new InternalBuffer(graphics_));
 		vk::BufferCreateInfo bufferInfo;
@@ -167,6 +191,22 @@ bool TextureVulkan::Initialize(GraphicsVulkan* graphics,
 		vk::MemoryAllocateInfo memAlloc;
 		memAlloc.allocationSize = memReqs.size;
 		memAlloc.memoryTypeIndex = GetMemoryTypeIndex(physicalDevice, memReqs.memoryTypeBits, vk::MemoryPropertyFlagBits::eDeviceLocal);
+
+		// memory of a transient attachment may not be allocated on tile based GPUs
+		if (isTransient)
+		{
+			auto memoryProperties = physicalDevice.getMemoryProperties();
+			for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++)
+			{
+				if ((memReqs.memoryTypeBits & (1 << i)) != 0 &&
+					(memoryProperties.memoryTypes[i].propertyFlags & vk::MemoryPropertyFlagBits::eLazilyAllocated))
+				{
+					memAlloc.memoryTypeIndex = i;
+					break;
+				}
+			}
+		}
+
 		devMem_ = device.allocateMemory(memAlloc);
 		device.bindImageMemory(image_, devMem_, 0);
 	}
@@ -206,32 +246,12 @@ bool TextureVulkan::Initialize(GraphicsVulkan* graphics,
 
 	ResetImageLayouts(mipmapCount_, imageCreateInfo.initialLayout);
 
-	if (!IsDepthFormat(parameter.Format) && graphics_ != nullptr)
+	if (!IsDepthFormat(parameter.Format) && !isTransient && graphics_ != nullptr)
 	{
-		vk::CommandBufferAllocateInfo cmdBufInfo;
-		cmdBufInfo.commandPool = graphics_->GetCommandPool();
-		cmdBufInfo.level = vk::CommandBufferLevel::ePrimary;
-		cmdBufInfo.commandBufferCount = 1;
-		auto cmdBuffers = graphics_->GetDevice().allocateCommandBuffersUnique(cmdBufInfo);
-
-		// a texture state must starts from undefined, so the states must be changed with a command buffer
-		vk::CommandBufferBeginInfo cmdBufferBeginInfo;
-		cmdBuffers[0]->begin(cmdBufferBeginInfo);
-		ResourceBarrier(cmdBuffers[0].get(), vk::ImageLayout::eShaderReadOnlyOptimal);
-		cmdBuffers[0]->end();
-		std::array<vk::SubmitInfo, 1> submitInfos;
-		submitInfos[0].commandBufferCount = 1;
-		submitInfos[0].pCommandBuffers = &(cmdBuffers[0].get());
-
-		const auto submitResult = graphics_->GetQueue().submit(static_cast<uint32_t>(submitInfos.size()), submitInfos.data(), vk::Fence());
-
-		if (submitResult != vk::Result::eSuccess)
-		{
-			LLGI::Log(LogType::Error, "Failed to submit");
-			return false;
-		}
-
-		graphics_->GetQueue().waitIdle();
+		// a texture state must starts from undefined, so the states must be changed with a command buffer.
+		// the change is batched with other textures and submitted before the next command list
+		ChangeImageLayout(vk::ImageLayout::eShaderReadOnlyOptimal);
+		graphics_->RegisterInitialLayoutTransition(this);
 	}
 
 	return true;
@@ -298,22 +318,35 @@ bool TextureVulkan::InitializeAsExternal(vk::Device device, const VulkanImageInf
 
 void* TextureVulkan::Lock()
 {
-	if (graphics_ == nullptr)
+	if (graphics_ == nullptr || cpuBuf == nullptr)
 		return nullptr;
 
+	// the staging buffer may still be read by an upload on the transfer queue
+	graphics_->WaitTransfer(this);
+
 	data = graphics_->GetDevice().mapMemory(cpuBuf->devMem(), 0, memorySize, vk::MemoryMapFlags());
 	return data;
 }
 
 void TextureVulkan::Unlock()
 {
-	if (graphics_ == nullptr)
+	if (graphics_ == nullptr || cpuBuf == nullptr)
 	{
 		return;
 	}
 
 	graphics_->GetDevice().unmapMemory(cpuBuf->devMem());
 
+	// the first upload doesn't need to be ordered with rendering, so it overlaps with the graphics queue
+	if (graphics_->IsTransferQueueEnabled() && graphics_->TakeInitialLayoutTransition(this))
+	{
+		if (!UnlockOnTransferQueue())
+		{
+			graphics_->RegisterInitialLayoutTransition(this);
+		}
+		return;
+	}
+
 	// copy buffer
 	vk::CommandBufferAllocateInfo cmdBufInfo;
 	cmdBufInfo.commandPool = graphics_->GetCommandPool();
@@ -325,6 +358,28 @@ void TextureVulkan::Unlock()
 
 	copyCommandBuffer.begin(cmdBufferBeginInfo);
 
+	// this texture may still wait for its initial transition, which is added into the queue before the copy
+	graphics_->FlushInitialLayoutTransitions();
+
+	vk::ImageLayout imageLayout = vk::ImageLayout::eTransferDstOptimal;
+	ResourceBarrier(copyCommandBuffer, imageLayout);
+	copyCommandBuffer.copyBufferToImage(cpuBuf->buffer(), image_, imageLayout, GetUploadRegion());
+	ResourceBarrier(copyCommandBuffer, vk::ImageLayout::eShaderReadOnlyOptimal);
+	copyCommandBuffer.end();
+
+	// submit after command lists which are executed before and wait to execute command
+	auto submissionQueue = graphics_->GetSubmissionQueue();
+	if (!submissionQueue->Wait(submissionQueue->Add(copyCommandBuffer)))
+	{
+		LLGI::Log(LogType::Error, "Failed to submit");
+		return;
+	}
+
+	graphics_->GetDevice().freeCommandBuffers(graphics_->GetCommandPool(), copyCommandBuffer);
+}
+
+vk::BufferImageCopy TextureVulkan::GetUploadRegion() const
+{
 	auto isArray = (parameter_.Usage & TextureUsageType::Array) != TextureUsageType::NoneFlag;
 
 	vk::BufferImageCopy imageBufferCopy;
@@ -342,39 +397,71 @@ void TextureVulkan::Unlock()
 	imageBufferCopy.imageExtent =
 		vk::Extent3D(static_cast<uint32_t>(GetSizeAs2D().X), static_cast<uint32_t>(GetSizeAs2D().Y), isArray ? 1 : parameter_.Size.Z);
 
-	vk::ImageSubresourceRange colorSubRange;
-	colorSubRange.aspectMask = vk::ImageAspectFlagBits::eColor;
-	colorSubRange.levelCount = 1;
-	colorSubRange.layerCount = isArray ? parameter_.Size.Z : 1;
+	return imageBufferCopy;
+}
 
-	vk::ImageLayout imageLayout = vk::ImageLayout::eTransferDstOptimal;
-	ResourceBarrier(copyCommandBuffer, imageLayout);
-	copyCommandBuffer.copyBufferToImage(cpuBuf->buffer(), image_, imageLayout, imageBufferCopy);
-	ResourceBarrier(copyCommandBuffer, vk::ImageLayout::eShaderReadOnlyOptimal);
-	copyCommandBuffer.end();
+bool TextureVulkan::UnlockOnTransferQueue()
+{
+	auto copyCommandBuffer = graphics_->BeginTransferCommands();
+
+	// the image has not been used on the graphics queue yet, so its contents are discarded
+	SetImageLayout(copyCommandBuffer, image_, vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal, subresourceRange_);
+	copyCommandBuffer.copyBufferToImage(cpuBuf->buffer(), image_, vk::ImageLayout::eTransferDstOptimal, GetUploadRegion());
+
+	// release the ownership to the graphics queue family
+	vk::ImageMemoryBarrier releaseBarrier;
+	releaseBarrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+	releaseBarrier.oldLayout = vk::ImageLayout::eTransferDstOptimal;
+	releaseBarrier.newLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+	releaseBarrier.srcQueueFamilyIndex = graphics_->GetTransferQueueFamilyIndex();
+	releaseBarrier.dstQueueFamilyIndex = graphics_->GetQueueFamilyIndex();
+	releaseBarrier.image = image_;
+	releaseBarrier.subresourceRange = subresourceRange_;
+	copyCommandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+									  vk::PipelineStageFlagBits::eBottomOfPipe,
+									  vk::DependencyFlags(),
+									  nullptr,
+									  nullptr,
+									  releaseBarrier);
 
-	// submit and wait to execute command
-	std::array<vk::SubmitInfo, 1> copySubmitInfos;
-	copySubmitInfos[0].commandBufferCount = 1;
-	copySubmitInfos[0].pCommandBuffers = &copyCommandBuffer;
+	copyCommandBuffer.end();
 
-	const auto submitResult =
-		graphics_->GetQueue().submit(static_cast<uint32_t>(copySubmitInfos.size()), copySubmitInfos.data(), vk::Fence());
-	if (submitResult != vk::Result::eSuccess)
+	if (!graphics_->SubmitTransferCommands(copyCommandBuffer, this))
 	{
-		LLGI::Log(LogType::Error, "Failed to submit");
-		return;
+		return false;
 	}
 
-	graphics_->GetQueue().waitIdle();
-
-	graphics_->GetDevice().freeCommandBuffers(graphics_->GetCommandPool(), copyCommandBuffer);
+	ChangeImageLayout(vk::ImageLayout::eShaderReadOnlyOptimal);
+	return true;
 }
 
 Vec2I TextureVulkan::GetSizeAs2D() const { return {textureSize.X, textureSize.Y}; }
 
 std::vector<vk::ImageLayout> TextureVulkan::GetImageLayouts() const { return imageLayouts_; }
 
+void TextureVulkan::RecordInitialLayoutTransition(vk::CommandBuffer& commandBuffer)
+{
+	SetImageLayout(commandBuffer, image_, vk::ImageLayout::eUndefined, vk::ImageLayout::eShaderReadOnlyOptimal, subresourceRange_);
+}
+
+void TextureVulkan::RecordTransferAcquire(vk::CommandBuffer& commandBuffer)
+{
+	vk::ImageMemoryBarrier acquireBarrier;
+	acquireBarrier.dstAccessMask = vk::AccessFlagBits::eShaderRead;
+	acquireBarrier.oldLayout = vk::ImageLayout::eTransferDstOptimal;
+	acquireBarrier.newLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+	acquireBarrier.srcQueueFamilyIndex = graphics_->GetTransferQueueFamilyIndex();
+	acquireBarrier.dstQueueFamilyIndex = graphics_->GetQueueFamilyIndex();
+	acquireBarrier.image = image_;
+	acquireBarrier.subresourceRange = subresourceRange_;
+	commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe,
+								  vk::PipelineStageFlagBits::eAllCommands,
+								  vk::DependencyFlags(),
+								  nullptr,
+								  nullptr,
+								  acquireBarrier);
+}
+
 void TextureVulkan::ChangeImageLayout(const vk::ImageLayout& imageLayout)
 {
 	for (int32_t i = 0; i < mipmapCount_; i++)
@@ -34,6 +34,10 @@ private:
 
 	void ResetImageLayouts(int32_t count, vk::ImageLayout layout);
 
+	vk::BufferImageCopy GetUploadRegion() const;
+
+	bool UnlockOnTransferQueue();
+
 public:
 	TextureVulkan();
 	~TextureVulkan() override;
@@ -68,6 +72,16 @@ public:
 
 	vk::ImageSubresourceRange GetSubresourceRange() const { return subresourceRange_; }
 
+	/**
+		@brief	record a transition from undefined into the layout which has been assumed since Initialize
+	*/
+	void RecordInitialLayoutTransition(vk::CommandBuffer& commandBuffer);
+
+	/**
+		@brief	record an acquisition of the ownership which is released by an upload on the transfer queue
+	*/
+	void RecordTransferAcquire(vk::CommandBuffer& commandBuffer);
+
 	void ChangeImageLayout(const vk::ImageLayout& imageLayout);
 
 	void ChangeImageLayout(int32_t mipLevel, const vk::ImageLayout& imageLayout);
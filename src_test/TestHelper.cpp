@@ -184,6 +184,8 @@ void TestHelper::SetRoot(const char* root)
 	helper->Root = root;
 }
 
+std::string TestHelper::GetRoot() { return Get()->Root; }
+
 void TestHelper::CreateRectangle(LLGI::Graphics* graphics,
 								 const LLGI::Vec3F& ul,
 								 const LLGI::Vec3F& lr,
@@ -36,6 +36,9 @@ public:
 
 	static void SetRoot(const char* root);
 
+	//! a directory of shaders for the device, which ends with a separator
+	static std::string GetRoot();
+
 	/**
 		@brief create a rectangle
 	*/
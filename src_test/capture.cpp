@@ -2,6 +2,8 @@
 #include "test.h"
 #include <Utils/LLGI.CommandListPool.h>
 #include <array>
+#include <cstring>
+#include <deque>
 
 void test_capture_texture(LLGI::DeviceType deviceType)
 {
@@ -188,6 +190,88 @@ void test_capture(LLGI::DeviceType deviceType, LLGI::Vec2I windowSize)
 	pips.clear();
 }
 
+void test_readback_texture(LLGI::DeviceType deviceType)
+{
+	int count = 0;
+
+	LLGI::PlatformParameter pp;
+	pp.Device = deviceType;
+	pp.WaitVSync = true;
+	auto window = std::unique_ptr<LLGI::Window>(LLGI::CreateWindow("Readback", LLGI::Vec2I(1280, 720)));
+	auto platform = LLGI::CreateSharedPtr(LLGI::CreatePlatform(pp, window.get()));
+	auto graphics = LLGI::CreateSharedPtr(platform->CreateGraphics());
+
+	auto sfMemoryPool = LLGI::CreateSharedPtr(graphics->CreateSingleFrameMemoryPool(1024 * 1024, 128));
+
+	auto commandListPool = std::make_shared<LLGI::CommandListPool>(graphics.get(), sfMemoryPool.get(), 3);
+
+	LLGI::TextureInitializationParameter texParam;
+	texParam.Size = LLGI::Vec2I(256, 256);
+	texParam.Format = LLGI::TextureFormatType::R8G8B8A8_UNORM;
+	auto texture = LLGI::CreateSharedPtr(graphics->CreateTexture(texParam));
+	TestHelper::WriteDummyTexture(texture.get());
+
+	const auto src = TestHelper::CreateDummyTextureData(texture->GetSizeAs2D(), texture->GetFormat());
+	const auto regionPosition = LLGI::Vec2I(16, 32);
+	const auto regionSize = LLGI::Vec2I(64, 48);
+
+	auto verify = [&](LLGI::ReadbackToken* token) -> void {
+		auto data = static_cast<const uint8_t*>(token->GetData());
+		VERIFY(data != nullptr);
+		VERIFY(token->GetRowPitch() == regionSize.X * 4);
+
+		for (int32_t y = 0; y < regionSize.Y; y++)
+		{
+			auto expected = src.data() + ((regionPosition.Y + y) * texture->GetSizeAs2D().X + regionPosition.X) * 4;
+			VERIFY(memcmp(data + y * token->GetRowPitch(), expected, regionSize.X * 4) == 0);
+		}
+	};
+
+	std::deque<std::shared_ptr<LLGI::ReadbackToken>> tokens;
+
+	while (count < 30)
+	{
+		if (!platform->NewFrame())
+			break;
+
+		sfMemoryPool->NewFrame();
+
+		auto renderPass = platform->GetCurrentScreen(LLGI::Color8(), true, false);
+
+		auto commandList = commandListPool->Get();
+		commandList->Begin();
+		auto token = commandList->ReadbackTexture(texture.get(), regionPosition, regionSize);
+		if (token == nullptr)
+		{
+			std::cout << "ReadbackTexture is not supported." << std::endl;
+			commandList->End();
+			return;
+		}
+		tokens.push_back(LLGI::CreateSharedPtr(token));
+		commandList->BeginRenderPass(renderPass);
+		commandList->EndRenderPass();
+		commandList->End();
+
+		graphics->Execute(commandList);
+
+		// read results of previous frames without waiting
+		while (tokens.size() > 0 && tokens.front()->IsReady())
+		{
+			verify(tokens.front().get());
+			tokens.pop_front();
+		}
+
+		platform->Present();
+		count++;
+	}
+
+	for (auto& token : tokens)
+	{
+		VERIFY(token->Wait());
+		verify(token.get());
+	}
+}
+
 #if defined(__linux__) || defined(__APPLE__) || defined(WIN32)
 
 TestRegister Capture_Size1279("Capture.Size1279", [](LLGI::DeviceType device) -> void { test_capture(device, LLGI::Vec2I(1279, 719)); });
@@ -198,4 +282,6 @@ TestRegister Capture_Size1280("Capture.Size1280", [](LLGI::DeviceType device) ->
 
 TestRegister Capture_Texture("Capture.Texture", [](LLGI::DeviceType device) -> void { test_capture_texture(device); });
 
+TestRegister Capture_ReadbackTexture("Capture.ReadbackTexture", [](LLGI::DeviceType device) -> void { test_readback_texture(device); });
+
 #endif
@@ -67,13 +67,14 @@ void test_clear_update(LLGI::DeviceType deviceType)
 	LLGI::SafeRelease(platform);
 }
 
-void test_clear(LLGI::DeviceType deviceType)
+void test_clear(LLGI::DeviceType deviceType, bool useSubmissionThread)
 {
 	int count = 0;
 
 	LLGI::PlatformParameter pp;
 	pp.Device = deviceType;
 	pp.WaitVSync = true;
+	pp.UseSubmissionThread = useSubmissionThread;
 	auto window = std::unique_ptr<LLGI::Window>(LLGI::CreateWindow("Clear", LLGI::Vec2I(1280, 720)));
 	auto platform = LLGI::CreatePlatform(pp, window.get());
 
@@ -134,6 +135,8 @@ void test_clear(LLGI::DeviceType deviceType)
 	LLGI::SafeRelease(platform);
 }
 
-TestRegister Clear_Basic("Clear.Basic", [](LLGI::DeviceType device) -> void { test_clear(device); });
+TestRegister Clear_Basic("Clear.Basic", [](LLGI::DeviceType device) -> void { test_clear(device, false); });
+
+TestRegister Clear_SubmissionThread("Clear.SubmissionThread", [](LLGI::DeviceType device) -> void { test_clear(device, true); });
 
 TestRegister Clear_Update("Clear.Update", [](LLGI::DeviceType device) -> void { test_clear_update(device); });
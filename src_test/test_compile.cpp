@@ -2,6 +2,70 @@
 #include "TestHelper.h"
 #include "test.h"
 
+#ifdef _WIN32
+#include <direct.h>
+#include <io.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+namespace
+{
+
+std::vector<std::string> GetFilesInDirectory(const std::string& directory)
+{
+	std::vector<std::string> files;
+
+#ifdef _WIN32
+	_finddata_t data;
+	auto handle = _findfirst((directory + "/*").c_str(), &data);
+	if (handle == -1)
+	{
+		return files;
+	}
+
+	do
+	{
+		if ((data.attrib & _A_SUBDIR) == 0)
+		{
+			files.push_back(directory + "/" + data.name);
+		}
+	} while (_findnext(handle, &data) == 0);
+
+	_findclose(handle);
+#else
+	auto dir = opendir(directory.c_str());
+	if (dir == nullptr)
+	{
+		return files;
+	}
+
+	while (auto entry = readdir(dir))
+	{
+		const std::string name = entry->d_name;
+		if (name != "." && name != "..")
+		{
+			files.push_back(directory + "/" + name);
+		}
+	}
+
+	closedir(dir);
+#endif
+
+	return files;
+}
+
+void RemoveFilesInDirectory(const std::string& directory)
+{
+	for (const auto& file : GetFilesInDirectory(directory))
+	{
+		remove(file.c_str());
+	}
+}
+
+} // namespace
+
 void test_compile(LLGI::DeviceType deviceType)
 {
 	auto compiler = LLGI::CreateCompiler(deviceType);
@@ -193,4 +257,146 @@ void main()
 	LLGI::SafeRelease(compiler);
 }
 
+void test_compile_cache(LLGI::DeviceType deviceType)
+{
+	if (deviceType != LLGI::DeviceType::Vulkan)
+	{
+		return;
+	}
+
+	auto compiler = LLGI::CreateSharedPtr(LLGI::CreateCompiler(deviceType));
+
+	if (compiler == nullptr)
+	{
+		return;
+	}
+
+	auto code = R"(
+#version 440 core
+layout(location = 0) in vec2 v_uv;
+layout(location = 0) out vec4 color;
+
+void main()
+{
+   color  = vec4(v_uv, 1.0, 1.0);
+}
+
+)";
+
+	// caches which are saved by previous runs are removed so that the first compile misses
+	const std::string cacheDirectory = "test_compile_cache";
+#ifdef _WIN32
+	_mkdir(cacheDirectory.c_str());
+#else
+	mkdir(cacheDirectory.c_str(), 0755);
+#endif
+	RemoveFilesInDirectory(cacheDirectory);
+
+	compiler->SetCacheDirectory(cacheDirectory.c_str());
+
+	// the first compile saves a cache
+	LLGI::CompilerResult result_first;
+	compiler->Compile(result_first, code, LLGI::ShaderStageType::Pixel);
+
+	if (result_first.Binary.size() != 1 || GetFilesInDirectory(cacheDirectory).size() != 1)
+	{
+		std::cout << result_first.Message.c_str() << std::endl;
+		abort();
+	}
+
+	// the second result is loaded from the cache
+	LLGI::CompilerResult result_second;
+	compiler->Compile(result_second, code, LLGI::ShaderStageType::Pixel);
+
+	if (result_first.Binary != result_second.Binary)
+	{
+		abort();
+	}
+
+	// a different stage is not loaded from the cache
+	LLGI::CompilerResult result_vs;
+	compiler->Compile(result_vs, code, LLGI::ShaderStageType::Vertex);
+
+	if (result_vs.Binary == result_first.Binary)
+	{
+		abort();
+	}
+
+	RemoveFilesInDirectory(cacheDirectory);
+}
+
+void test_compile_batch(LLGI::DeviceType deviceType)
+{
+	if (deviceType != LLGI::DeviceType::Vulkan)
+	{
+		return;
+	}
+
+	auto compiler = LLGI::CreateSharedPtr(LLGI::CreateCompiler(deviceType));
+
+	if (compiler == nullptr)
+	{
+		return;
+	}
+
+	auto code_vs = R"(
+#version 440 core
+layout(location = 0) in vec3 a_position;
+
+void main()
+{
+	gl_Position = vec4(a_position, 1.0f);
+}
+
+)";
+
+	auto code_ps = R"(
+#version 440 core
+layout(location = 0) out vec4 color;
+
+void main()
+{
+   color  = vec4(1.0, 1.0, 1.0, 1.0);
+}
+
+)";
+
+	std::vector<LLGI::CompilerInput> inputs;
+	for (int i = 0; i < 16; i++)
+	{
+		LLGI::CompilerInput input;
+		input.Code = i % 2 == 0 ? code_vs : code_ps;
+		input.ShaderStage = i % 2 == 0 ? LLGI::ShaderStageType::Vertex : LLGI::ShaderStageType::Pixel;
+		inputs.push_back(input);
+	}
+
+	std::vector<LLGI::CompilerResult> results;
+	compiler->CompileBatch(results, inputs);
+
+	// results are same as ones which are compiled one by one
+	LLGI::CompilerResult result_vs;
+	LLGI::CompilerResult result_ps;
+	compiler->Compile(result_vs, code_vs, LLGI::ShaderStageType::Vertex);
+	compiler->Compile(result_ps, code_ps, LLGI::ShaderStageType::Pixel);
+
+	if (results.size() != inputs.size() || result_vs.Binary.size() != 1 || result_ps.Binary.size() != 1)
+	{
+		abort();
+	}
+
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const auto& expected = i % 2 == 0 ? result_vs : result_ps;
+		if (results[i].Binary != expected.Binary)
+		{
+			std::cout << results[i].Message.c_str() << std::endl;
+			abort();
+		}
+	}
+}
+
 TestRegister Compile_Basic("Compile.Basic", [](LLGI::DeviceType device) -> void { test_compile(device); });
+
+TestRegister Compile_Cache("Compile.Cache", [](LLGI::DeviceType device) -> void { test_compile_cache(device); });
+
+TestRegister Compile_Batch("Compile.Batch", [](LLGI::DeviceType device) -> void { test_compile_batch(device); });
@@ -15,7 +15,7 @@ struct OutputData
 	float value;
 };
 
-void test_compute_shader(LLGI::DeviceType deviceType, bool is_read_only)
+void test_compute_shader(LLGI::DeviceType deviceType, bool is_read_only, bool is_readback = false, bool is_async = false)
 {
 	LLGI::PlatformParameter pp;
 	pp.Device = deviceType;
@@ -98,20 +98,89 @@ void test_compute_shader(LLGI::DeviceType deviceType, bool is_read_only)
 
 	sfMemoryPool->NewFrame();
 
+	auto dispatch = [&](LLGI::CommandList* commandList) -> void {
+		commandList->BeginComputePass();
+		commandList->SetPipelineState(pip.get());
+		commandList->SetComputeBuffer(inputComputeBuffer.get(), sizeof(InputData), 0, is_read_only);
+		commandList->SetComputeBuffer(outputComputeBuffer.get(), sizeof(OutputData), 1, false);
+		commandList->SetConstantBuffer(constantBuffer.get(), 0);
+		commandList->Dispatch(dataSize, 1, 1, 1, 1, 1);
+		commandList->EndComputePass();
+	};
+
+	std::shared_ptr<LLGI::CommandList> computeCommandList;
+	if (is_async)
+	{
+		computeCommandList = LLGI::CreateSharedPtr(graphics->CreateComputeCommandList(sfMemoryPool.get()));
+		if (computeCommandList == nullptr)
+		{
+			abort();
+		}
+
+		// upload on the graphics queue, dispatch on the compute queue and copy the result on the graphics queue
+		auto uploadCommandList = commandListPool->Get();
+		uploadCommandList->Begin();
+		uploadCommandList->CopyBuffer(inputBuffer.get(), inputComputeBuffer.get());
+		uploadCommandList->End();
+		graphics->Execute(uploadCommandList);
+
+		computeCommandList->Begin();
+		computeCommandList->WaitCommandList(uploadCommandList);
+		dispatch(computeCommandList.get());
+		computeCommandList->End();
+		graphics->Execute(computeCommandList.get());
+	}
+
 	auto commandList = commandListPool->Get();
 	commandList->Begin();
-	commandList->CopyBuffer(inputBuffer.get(), inputComputeBuffer.get());
-	commandList->BeginComputePass();
-	commandList->SetPipelineState(pip.get());
-	commandList->SetComputeBuffer(inputComputeBuffer.get(), sizeof(InputData), 0, is_read_only);
-	commandList->SetComputeBuffer(outputComputeBuffer.get(), sizeof(OutputData), 1, false);
-	commandList->SetConstantBuffer(constantBuffer.get(), 0);
-	commandList->Dispatch(dataSize, 1, 1, 1, 1, 1);
-	commandList->EndComputePass();
+	if (is_async)
+	{
+		commandList->WaitCommandList(computeCommandList.get());
+	}
+	else
+	{
+		commandList->CopyBuffer(inputBuffer.get(), inputComputeBuffer.get());
+		dispatch(commandList);
+	}
 	commandList->CopyBuffer(outputComputeBuffer.get(), outputBuffer.get());
+
+	std::shared_ptr<LLGI::ReadbackToken> readbackToken;
+	if (is_readback)
+	{
+		readbackToken = LLGI::CreateSharedPtr(commandList->ReadbackBuffer(outputComputeBuffer.get(), 0, sizeof(OutputData) * dataSize));
+		if (readbackToken == nullptr)
+		{
+			std::cout << "ReadbackBuffer is not supported." << std::endl;
+		}
+	}
+
 	commandList->End();
 
 	graphics->Execute(commandList);
+
+	if (readbackToken != nullptr)
+	{
+		if (!readbackToken->Wait())
+		{
+			abort();
+		}
+
+		auto dst = static_cast<const OutputData*>(readbackToken->GetData());
+		if (dst == nullptr)
+		{
+			abort();
+		}
+
+		for (int i = 0; i < dataSize; i++)
+		{
+			const auto expected = inputData[i].value1 * inputData[i].value2 + offsetValue;
+			if (expected != dst[i].value)
+			{
+				abort();
+			}
+		}
+	}
+
 	graphics->WaitFinish();
 
 	{
@@ -141,3 +210,7 @@ TestRegister ComputeShader_Basic("ComputeShader.Basic", [](LLGI::DeviceType devi
 
 TestRegister ComputeShader_Basic_ReadOnly("ComputeShader.Basic_ReadOnly",
 										  [](LLGI::DeviceType device) -> void { test_compute_shader(device, true); });
+
+TestRegister ComputeShader_Readback("ComputeShader.Readback", [](LLGI::DeviceType device) -> void { test_compute_shader(device, false, true); });
+
+TestRegister ComputeShader_Async("ComputeShader.Async", [](LLGI::DeviceType device) -> void { test_compute_shader(device, false, false, true); });
@@ -1,5 +1,7 @@
 #include "TestHelper.h"
 #include "test.h"
+#include <fstream>
+#include <thread>
 
 void test_empty(LLGI::DeviceType deviceType)
 {
@@ -26,4 +28,282 @@ void test_empty(LLGI::DeviceType deviceType)
 	LLGI::SafeRelease(platform);
 }
 
+void test_headless(LLGI::DeviceType deviceType)
+{
+	if (deviceType != LLGI::DeviceType::Vulkan)
+	{
+		return;
+	}
+
+	int count = 0;
+
+	LLGI::PlatformParameter pp;
+	pp.Device = deviceType;
+	pp.Headless = true;
+	auto platform = LLGI::CreatePlatform(pp, nullptr);
+	if (platform == nullptr)
+	{
+		abort();
+	}
+
+	auto graphics = platform->CreateGraphics();
+	auto sfMemoryPool = graphics->CreateSingleFrameMemoryPool(1024 * 1024, 128);
+
+	std::array<LLGI::CommandList*, 3> commandLists;
+	for (size_t i = 0; i < commandLists.size(); i++)
+		commandLists[i] = graphics->CreateCommandList(sfMemoryPool);
+
+	LLGI::RenderTextureInitializationParameter params;
+	params.Size = LLGI::Vec2I(256, 256);
+	auto renderTexture = graphics->CreateRenderTexture(params);
+	auto renderPass = graphics->CreateRenderPass(&renderTexture, 1, nullptr);
+
+	LLGI::Color8 color;
+	color.R = 255;
+	color.G = 0;
+	color.B = 0;
+	color.A = 255;
+	renderPass->SetClearColor(color);
+	renderPass->SetIsColorCleared(true);
+
+	while (count < 60)
+	{
+		if (!platform->NewFrame())
+			break;
+
+		// a screen doesn't exist
+		if (platform->GetCurrentScreen()->GetRenderTextureCount() != 0)
+		{
+			abort();
+		}
+
+		sfMemoryPool->NewFrame();
+
+		auto commandList = commandLists[count % commandLists.size()];
+		commandList->Begin();
+		commandList->BeginRenderPass(renderPass);
+		commandList->EndRenderPass();
+		commandList->End();
+
+		graphics->Execute(commandList);
+
+		platform->Present();
+		count++;
+	}
+
+	graphics->WaitFinish();
+
+	auto data = graphics->CaptureRenderTarget(renderTexture);
+	if (data.size() < 4 || data[0] != color.R || data[1] != color.G || data[2] != color.B)
+	{
+		abort();
+	}
+
+	LLGI::SafeRelease(renderPass);
+	LLGI::SafeRelease(renderTexture);
+	LLGI::SafeRelease(sfMemoryPool);
+	for (size_t i = 0; i < commandLists.size(); i++)
+		LLGI::SafeRelease(commandLists[i]);
+	LLGI::SafeRelease(graphics);
+	LLGI::SafeRelease(platform);
+}
+
+void test_multi_graphics(LLGI::DeviceType deviceType)
+{
+	if (deviceType != LLGI::DeviceType::Vulkan)
+	{
+		return;
+	}
+
+	LLGI::PlatformParameter pp;
+	pp.Device = deviceType;
+	pp.Headless = true;
+	auto platform = LLGI::CreatePlatform(pp, nullptr);
+	if (platform == nullptr)
+	{
+		abort();
+	}
+
+	// each thread renders with its own graphics on the same device
+	auto render = [platform](uint8_t red, bool* succeeded) -> void {
+		auto graphics = platform->CreateGraphics();
+		auto sfMemoryPool = graphics->CreateSingleFrameMemoryPool(1024 * 1024, 128);
+
+		std::array<LLGI::CommandList*, 3> commandLists;
+		for (size_t i = 0; i < commandLists.size(); i++)
+			commandLists[i] = graphics->CreateCommandList(sfMemoryPool);
+
+		LLGI::RenderTextureInitializationParameter params;
+		params.Size = LLGI::Vec2I(256, 256);
+		auto renderTexture = graphics->CreateRenderTexture(params);
+		auto renderPass = graphics->CreateRenderPass(&renderTexture, 1, nullptr);
+
+		LLGI::Color8 color;
+		color.R = red;
+		color.G = 0;
+		color.B = 0;
+		color.A = 255;
+		renderPass->SetClearColor(color);
+		renderPass->SetIsColorCleared(true);
+
+		for (int count = 0; count < 60; count++)
+		{
+			sfMemoryPool->NewFrame();
+
+			auto commandList = commandLists[count % commandLists.size()];
+			commandList->Begin();
+			commandList->BeginRenderPass(renderPass);
+			commandList->EndRenderPass();
+			commandList->End();
+
+			graphics->Execute(commandList);
+			graphics->Flush();
+		}
+
+		graphics->WaitFinish();
+
+		auto data = graphics->CaptureRenderTarget(renderTexture);
+		*succeeded = data.size() >= 4 && data[0] == color.R && data[1] == color.G && data[2] == color.B;
+
+		LLGI::SafeRelease(renderPass);
+		LLGI::SafeRelease(renderTexture);
+		LLGI::SafeRelease(sfMemoryPool);
+		for (size_t i = 0; i < commandLists.size(); i++)
+			LLGI::SafeRelease(commandLists[i]);
+		LLGI::SafeRelease(graphics);
+	};
+
+	bool succeeded1 = false;
+	bool succeeded2 = false;
+	std::thread thread1(render, 255, &succeeded1);
+	std::thread thread2(render, 128, &succeeded2);
+	thread1.join();
+	thread2.join();
+
+	if (!succeeded1 || !succeeded2)
+	{
+		abort();
+	}
+
+	LLGI::SafeRelease(platform);
+}
+
+void test_pipeline_cache(LLGI::DeviceType deviceType)
+{
+	if (deviceType != LLGI::DeviceType::Vulkan)
+	{
+		return;
+	}
+
+	const char* path = "PipelineCache.bin";
+	remove(path);
+
+	LLGI::PlatformParameter pp;
+	pp.Device = deviceType;
+	pp.Headless = true;
+	pp.PipelineCachePath = path;
+
+	// the first run saves a cache and the second run loads it
+	for (int i = 0; i < 2; i++)
+	{
+		auto platform = LLGI::CreatePlatform(pp, nullptr);
+		if (platform == nullptr)
+		{
+			abort();
+		}
+
+		LLGI::SafeRelease(platform);
+
+		std::ifstream file(path, std::ios::binary);
+		if (!file)
+		{
+			abort();
+		}
+	}
+
+	remove(path);
+}
+
+void test_pipeline_manifest(LLGI::DeviceType deviceType)
+{
+	if (deviceType != LLGI::DeviceType::Vulkan)
+	{
+		return;
+	}
+
+	const char* path = "PipelineManifest.bin";
+	remove(path);
+
+	LLGI::PlatformParameter pp;
+	pp.Device = deviceType;
+	pp.Headless = true;
+	pp.PipelineManifestPath = path;
+
+	// the first run records a pipeline and the second run prewarms it
+	for (int i = 0; i < 2; i++)
+	{
+		auto platform = LLGI::CreatePlatform(pp, nullptr);
+		if (platform == nullptr)
+		{
+			abort();
+		}
+
+		auto graphics = platform->CreateGraphics();
+
+		std::shared_ptr<LLGI::Shader> shader_vs = nullptr;
+		std::shared_ptr<LLGI::Shader> shader_ps = nullptr;
+		TestHelper::CreateShader(graphics, deviceType, "simple_rectangle.vert", "simple_rectangle.frag", shader_vs, shader_ps);
+
+		if (i == 0)
+		{
+			LLGI::RenderTextureInitializationParameter params;
+			params.Size = LLGI::Vec2I(256, 256);
+			auto renderTexture = graphics->CreateRenderTexture(params);
+			auto renderPass = graphics->CreateRenderPass(&renderTexture, 1, nullptr);
+			auto renderPassPipelineState = graphics->CreateRenderPassPipelineState(renderPass);
+
+			auto pip = graphics->CreatePiplineState();
+			pip->VertexLayouts[0] = LLGI::VertexLayoutFormat::R32G32B32_FLOAT;
+			pip->VertexLayouts[1] = LLGI::VertexLayoutFormat::R32G32_FLOAT;
+			pip->VertexLayouts[2] = LLGI::VertexLayoutFormat::R8G8B8A8_UNORM;
+			pip->VertexLayoutCount = 3;
+			pip->SetShader(LLGI::ShaderStageType::Vertex, shader_vs.get());
+			pip->SetShader(LLGI::ShaderStageType::Pixel, shader_ps.get());
+			pip->SetRenderPassPipelineState(renderPassPipelineState);
+			if (!pip->Compile())
+			{
+				abort();
+			}
+
+			LLGI::SafeRelease(pip);
+			LLGI::SafeRelease(renderPassPipelineState);
+			LLGI::SafeRelease(renderPass);
+			LLGI::SafeRelease(renderTexture);
+		}
+		else
+		{
+			std::array<LLGI::Shader*, 2> shaders = {shader_vs.get(), shader_ps.get()};
+			if (graphics->PrewarmPipelines(path, shaders.data(), static_cast<int32_t>(shaders.size())) != 1)
+			{
+				abort();
+			}
+		}
+
+		shader_vs.reset();
+		shader_ps.reset();
+		LLGI::SafeRelease(graphics);
+		LLGI::SafeRelease(platform);
+	}
+
+	remove(path);
+}
+
 TestRegister Empty_Basic("Empty.Basic", [](LLGI::DeviceType device) -> void { test_empty(device); });
+
+TestRegister Empty_Headless("Empty.Headless", [](LLGI::DeviceType device) -> void { test_headless(device); });
+
+TestRegister Empty_MultiGraphics("Empty.MultiGraphics", [](LLGI::DeviceType device) -> void { test_multi_graphics(device); });
+
+TestRegister Empty_PipelineCache("Empty.PipelineCache", [](LLGI::DeviceType device) -> void { test_pipeline_cache(device); });
+
+TestRegister Empty_PipelineManifest("Empty.PipelineManifest", [](LLGI::DeviceType device) -> void { test_pipeline_manifest(device); });
@@ -1,26 +1,37 @@
 #include "TestHelper.h"
 #include "test.h"
+#include <Utils/LLGI.CommandListPool.h>
+#include <Utils/LLGI.RenderTargetPool.h>
 #include <array>
 #include <map>
+#include <set>
 
 enum class RenderPassTestMode
 {
 	None,
 	MSAA,
 	MSAADepth,
+	MSAATransient,
 	CopyTexture,
 };
 
 void test_renderPass(LLGI::DeviceType deviceType, RenderPassTestMode mode)
 {
 #if !(defined(__linux__) || defined(__APPLE__) || defined(WIN32))
-	if (mode == RenderPassTestMode::MSAA || mode == RenderPassTestMode::MSAADepth)
+	if (mode == RenderPassTestMode::MSAA || mode == RenderPassTestMode::MSAADepth || mode == RenderPassTestMode::MSAATransient)
 	{
 		return;
 	}
 #endif
 
-	bool isMSAATest = mode == RenderPassTestMode::MSAA || mode == RenderPassTestMode::MSAADepth;
+	// transient attachments are implemented only in Vulkan
+	if (mode == RenderPassTestMode::MSAATransient && deviceType != LLGI::DeviceType::Vulkan)
+	{
+		return;
+	}
+
+	bool isMSAATest =
+		mode == RenderPassTestMode::MSAA || mode == RenderPassTestMode::MSAADepth || mode == RenderPassTestMode::MSAATransient;
 
 	int count = 0;
 
@@ -45,7 +56,23 @@ void test_renderPass(LLGI::DeviceType deviceType, RenderPassTestMode mode)
 		params.SamplingCount = 4;
 	}
 
-	auto renderTexture = graphics->CreateRenderTexture(params);
+	LLGI::Texture* renderTexture = nullptr;
+
+	if (mode == RenderPassTestMode::MSAATransient)
+	{
+		// the multisampled image is resolved in the render pass and never read later
+		LLGI::TextureParameter transientParam;
+		transientParam.Usage = LLGI::TextureUsageType::RenderTarget | LLGI::TextureUsageType::Transient;
+		transientParam.Format = params.Format;
+		transientParam.Size = LLGI::Vec3I(params.Size.X, params.Size.Y, 1);
+		transientParam.SampleCount = params.SamplingCount;
+		renderTexture = graphics->CreateTexture(transientParam);
+	}
+	else
+	{
+		renderTexture = graphics->CreateRenderTexture(params);
+	}
+
 	assert(renderTexture->GetType() == LLGI::TextureType::Render);
 
 	params.SamplingCount = 1;
@@ -54,6 +81,17 @@ void test_renderPass(LLGI::DeviceType deviceType, RenderPassTestMode mode)
 	LLGI::Texture* depthTexture = nullptr;
 	LLGI::Texture* depthTextureDst = nullptr;
 
+	if (mode == RenderPassTestMode::MSAATransient)
+	{
+		LLGI::TextureParameter depthParam;
+		depthParam.Usage = LLGI::TextureUsageType::Transient;
+		depthParam.Format = LLGI::TextureFormatType::D32;
+		depthParam.Size = LLGI::Vec3I(params.Size.X, params.Size.Y, 1);
+		depthParam.SampleCount = 4;
+
+		depthTexture = graphics->CreateTexture(depthParam);
+	}
+
 	if (mode == RenderPassTestMode::MSAADepth)
 	{
 		LLGI::DepthTextureInitializationParameter depthParam;
@@ -85,6 +123,10 @@ void test_renderPass(LLGI::DeviceType deviceType, RenderPassTestMode mode)
 	{
 		renderPass = graphics->CreateRenderPass(renderTexture, renderTextureDst, nullptr, nullptr);
 	}
+	else if (mode == RenderPassTestMode::MSAATransient)
+	{
+		renderPass = graphics->CreateRenderPass(renderTexture, renderTextureDst, depthTexture, nullptr);
+	}
 	else
 	{
 		renderPass = graphics->CreateRenderPass(&renderTexture, 1, nullptr);
@@ -608,6 +650,76 @@ void test_multiRenderPass(LLGI::DeviceType deviceType)
 	LLGI::SafeRelease(compiler);
 }
 
+void test_renderTargetPool(LLGI::DeviceType deviceType)
+{
+	int count = 0;
+
+	LLGI::PlatformParameter pp;
+	pp.Device = deviceType;
+	pp.WaitVSync = true;
+	auto window = std::unique_ptr<LLGI::Window>(LLGI::CreateWindow("RenderTargetPool", LLGI::Vec2I(1280, 720)));
+	auto platform = LLGI::CreateSharedPtr(LLGI::CreatePlatform(pp, window.get()));
+	auto graphics = LLGI::CreateSharedPtr(platform->CreateGraphics());
+
+	auto sfMemoryPool = LLGI::CreateSharedPtr(graphics->CreateSingleFrameMemoryPool(1024 * 1024, 128));
+
+	auto commandListPool = std::make_shared<LLGI::CommandListPool>(graphics.get(), sfMemoryPool.get(), 3);
+
+	const int32_t frameCount = 3;
+	auto renderTargetPool = std::make_shared<LLGI::RenderTargetPool>(graphics.get(), frameCount);
+
+	LLGI::TextureParameter texParam;
+	texParam.Usage = LLGI::TextureUsageType::RenderTarget;
+	texParam.Size = LLGI::Vec3I(256, 256, 1);
+
+	std::set<LLGI::Texture*> textures;
+	std::set<LLGI::RenderPass*> renderPasses;
+
+	while (count < 30)
+	{
+		if (!platform->NewFrame())
+			break;
+
+		sfMemoryPool->NewFrame();
+		renderTargetPool->NewFrame();
+
+		auto commandList = commandListPool->Get();
+		commandList->Begin();
+
+		// a chain of intermediate targets
+		for (int32_t i = 0; i < 2; i++)
+		{
+			auto texture = renderTargetPool->GetTexture(texParam);
+			VERIFY(texture != nullptr);
+			textures.insert(texture);
+
+			auto renderPass = renderTargetPool->GetRenderPass(&texture, 1, nullptr);
+			VERIFY(renderPass != nullptr);
+			renderPasses.insert(renderPass);
+
+			renderPass->SetIsColorCleared(true);
+			renderPass->SetClearColor(LLGI::Color8(count % 255, 0, 0, 255));
+			commandList->BeginRenderPass(renderPass);
+			commandList->EndRenderPass();
+		}
+
+		commandList->BeginRenderPass(platform->GetCurrentScreen(LLGI::Color8(), true, false));
+		commandList->EndRenderPass();
+		commandList->End();
+
+		graphics->Execute(commandList);
+
+		platform->Present();
+		count++;
+	}
+
+	// targets are reused after warm-up
+	VERIFY(textures.size() <= static_cast<size_t>(2 * (frameCount + 1)));
+	VERIFY(renderPasses.size() == textures.size());
+
+	graphics->WaitFinish();
+}
+
 TestRegister RenderPass_Basic("RenderPass.Basic",
 							  [](LLGI::DeviceType device) -> void { test_renderPass(device, RenderPassTestMode::None); });
 
@@ -616,6 +728,9 @@ TestRegister RenderPass_MSAA("RenderPass.MSAA", [](LLGI::DeviceType device) -> v
 TestRegister RenderPass_MSAADepth("RenderPass.MSAADepth",
 								  [](LLGI::DeviceType device) -> void { test_renderPass(device, RenderPassTestMode::MSAADepth); });
 
+TestRegister RenderPass_MSAATransient("RenderPass.MSAATransient",
+									  [](LLGI::DeviceType device) -> void { test_renderPass(device, RenderPassTestMode::MSAATransient); });
+
 TestRegister RenderPass_CopyTexture("RenderPass.CopyTexture",
 									[](LLGI::DeviceType device) -> void { test_renderPass(device, RenderPassTestMode::CopyTexture); });
 
@@ -623,3 +738,6 @@ TestRegister RenderPass_CopyTextureToScreen("RenderPass.CopyTextureToScreen",
 											[](LLGI::DeviceType device) -> void { test_copyTextureToScreen(device); });
 
 TestRegister RenderPass_MRT("RenderPass.MRT", [](LLGI::DeviceType device) -> void { test_multiRenderPass(device); });
+
+TestRegister RenderPass_RenderTargetPool("RenderPass.RenderTargetPool",
+										 [](LLGI::DeviceType device) -> void { test_renderTargetPool(device); });
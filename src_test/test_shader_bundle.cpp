@@ -0,0 +1,112 @@
+#include "TestHelper.h"
+#include "test.h"
+#include <LLGI.ShaderBundle.h>
+#include <fstream>
+#include <string.h>
+
+void test_shader_bundle(LLGI::DeviceType deviceType)
+{
+	// a bundle is written by ShaderTranspiler --bundle from directories of shaders when tools are built
+#ifdef LLGI_TEST_SHADER_BUNDLE
+	if (TestHelper::GetRoot() == "")
+	{
+		return;
+	}
+
+	const auto shaderDirectory = TestHelper::GetRoot() + "../";
+	const std::string bundlePath = LLGI_TEST_SHADER_BUNDLE;
+
+	auto bundle = LLGI::CreateSharedPtr(LLGI::CreateShaderBundle(bundlePath.c_str()));
+	if (bundle == nullptr || bundle->GetEntryCount() == 0)
+	{
+		abort();
+	}
+
+	// entries are same as files which are packed
+	const std::vector<std::string> targets = {"HLSL_DX12", "Metal", "GLSL_VULKAN", "GLSL_GL", "SPIRV"};
+	const std::vector<std::pair<std::string, LLGI::ShaderStageType>> names = {
+		{"simple_rectangle.vert", LLGI::ShaderStageType::Vertex},
+		{"simple_rectangle.frag", LLGI::ShaderStageType::Pixel},
+		{"basic.comp", LLGI::ShaderStageType::Compute},
+	};
+
+	for (const auto& target : targets)
+	{
+		for (const auto& name : names)
+		{
+			auto entry = bundle->Find(target.c_str(), name.first.c_str());
+			if (entry == nullptr || entry->ShaderStage != static_cast<uint32_t>(name.second))
+			{
+				abort();
+			}
+
+			const auto path = shaderDirectory + target + "/" + name.first + (target == "SPIRV" ? ".spv" : "");
+			const auto file = TestHelper::LoadDataWithoutRoot(path.c_str());
+
+			// data points into the mapped file and is aligned for SPIR-V
+			auto data = bundle->GetData(entry);
+			if (data.Size != static_cast<int32_t>(file.size()) || memcmp(data.Data, file.data(), file.size()) != 0 ||
+				reinterpret_cast<uintptr_t>(data.Data) % sizeof(uint32_t) != 0)
+			{
+				abort();
+			}
+
+			// reflection is shared by all targets
+			auto reflection = bundle->GetReflection(entry);
+			if (reflection == nullptr || reflection != bundle->GetReflection(bundle->Find("SPIRV", name.first.c_str())))
+			{
+				abort();
+			}
+		}
+	}
+
+	{
+		auto reflection = bundle->GetReflection(bundle->Find("SPIRV", "basic.comp"));
+		auto uniforms = bundle->GetUniforms(reflection);
+		if (reflection->NumThreads[0] != 1 || reflection->NumThreads[1] != 1 || reflection->NumThreads[2] != 1 ||
+			reflection->UniformCount != 1 || strcmp(bundle->GetName(&uniforms[0]), "offset") != 0 || uniforms[0].Offset != 0 ||
+			uniforms[0].Size != sizeof(float))
+		{
+			abort();
+		}
+	}
+
+	if (bundle->Find("SPIRV", "simple_rectangle.vert", "NAME=VALUE") != nullptr || bundle->Find("SPIRV", "unknown.vert") != nullptr)
+	{
+		abort();
+	}
+
+	// shaders are created from the mapped file
+	if (deviceType == LLGI::DeviceType::Vulkan)
+	{
+		LLGI::PlatformParameter pp;
+		pp.Device = deviceType;
+		pp.Headless = true;
+		auto platform = LLGI::CreateSharedPtr(LLGI::CreatePlatform(pp, nullptr));
+		auto graphics = LLGI::CreateSharedPtr(platform->CreateGraphics());
+
+		auto vs = LLGI::CreateSharedPtr(bundle->CreateShader(graphics.get(), "SPIRV", "simple_rectangle.vert"));
+		auto ps = LLGI::CreateSharedPtr(bundle->CreateShader(graphics.get(), "SPIRV", "simple_rectangle.frag"));
+		if (vs == nullptr || ps == nullptr)
+		{
+			abort();
+		}
+	}
+
+	// a truncated bundle is not loaded
+	auto broken = TestHelper::LoadDataWithoutRoot(bundlePath.c_str());
+	broken.resize(broken.size() / 2);
+
+	{
+		std::ofstream file("test_shader_bundle.bundle", std::ios::binary);
+		file.write(reinterpret_cast<const char*>(broken.data()), broken.size());
+	}
+
+	if (LLGI::CreateSharedPtr(LLGI::CreateShaderBundle("test_shader_bundle.bundle")) != nullptr)
+	{
+		abort();
+	}
+#endif
+}
+
+TestRegister ShaderBundle_Load("ShaderBundle.Load", [](LLGI::DeviceType device) -> void { test_shader_bundle(device); });
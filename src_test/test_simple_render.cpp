@@ -13,6 +13,7 @@ enum class SingleRectangleTestMode
 	Triangle,
 	Line,
 	Point,
+	TriangleAsync,
 };
 
 enum class SimpleTextureRectangleTestMode
@@ -93,7 +94,7 @@ void test_simple_rectangle(LLGI::DeviceType deviceType, SingleRectangleTestMode
 			pip->VertexLayoutNames[2] = "COLOR";
 			pip->VertexLayoutCount = 3;
 
-			if (mode == SingleRectangleTestMode::Triangle)
+			if (mode == SingleRectangleTestMode::Triangle || mode == SingleRectangleTestMode::TriangleAsync)
 			{
 				pip->Topology = LLGI::TopologyType::Triangle;
 			}
@@ -109,7 +110,17 @@ void test_simple_rectangle(LLGI::DeviceType deviceType, SingleRectangleTestMode
 			pip->SetShader(LLGI::ShaderStageType::Vertex, shader_vs.get());
 			pip->SetShader(LLGI::ShaderStageType::Pixel, shader_ps.get());
 			pip->SetRenderPassPipelineState(renderPassPipelineState.get());
-			if (!pip->Compile())
+
+			if (mode == SingleRectangleTestMode::TriangleAsync)
+			{
+				// the first draw waits for the compilation
+				pip->NotReadyPolicy = LLGI::PipelineNotReadyPolicy::Wait;
+				if (!pip->CompileAsync())
+				{
+					abort();
+				}
+			}
+			else if (!pip->Compile())
 			{
 				abort();
 			}
@@ -153,6 +164,11 @@ void test_simple_rectangle(LLGI::DeviceType deviceType, SingleRectangleTestMode
 				Bitmap2D(data, texture->GetSizeAs2D().X, texture->GetSizeAs2D().Y, texture->GetFormat())
 					.Save("SimpleRender.BasicPoint_" + TestHelper::GetDeviceName(deviceType) + ".png");
 			}
+			else if (mode == SingleRectangleTestMode::TriangleAsync)
+			{
+				Bitmap2D(data, texture->GetSizeAs2D().X, texture->GetSizeAs2D().Y, texture->GetFormat())
+					.Save("SimpleRender.BasicTriangleAsync_" + TestHelper::GetDeviceName(deviceType) + ".png");
+			}
 			break;
 		}
 	}
@@ -1202,6 +1218,10 @@ TestRegister SimpleRender_BasicPoint("SimpleRender.BasicPoint",
 									 [](LLGI::DeviceType device) -> void
 									 { test_simple_rectangle(device, SingleRectangleTestMode::Point); });
 
+TestRegister SimpleRender_BasicTriangleAsync("SimpleRender.BasicTriangleAsync",
+											 [](LLGI::DeviceType device) -> void
+											 { test_simple_rectangle(device, SingleRectangleTestMode::TriangleAsync); });
+
 TestRegister SimpleRender_IndexOffset("SimpleRender.IndexOffset", [](LLGI::DeviceType device) -> void { test_index_offset(device); });
 
 TestRegister SimpleRender_ConstantLT("SimpleRender.ConstantLT",
@@ -1,8 +1,19 @@
 
+#include "../../src/LLGI.ShaderBundle.h"
+#include "../../src/Utils/LLGI.WorkerPool.h"
 #include <ShaderTranspilerCore.h>
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <cstring>
 #include <fstream>
 #include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
 #include <string>
+#include <thread>
+#include <tuple>
 #include <vector>
 
 enum class OutputType
@@ -14,42 +25,121 @@ enum class OutputType
 	Max,
 };
 
-int main(int argc, char* argv[])
+struct TranspilerOption
 {
+	bool isES = false;
+	bool isDX12 = false;
+	bool plain = false;
+	int shaderModel = 0;
+};
 
-	std::vector<std::string> args;
+//! a shader which is transpiled into outputs
+struct TranspileJob
+{
+	LLGI::ShaderStageType shaderStage = LLGI::ShaderStageType::Max;
+	std::string inputPath;
+	TranspilerOption option;
+	bool isParallel = false;
+	std::vector<LLGI::SPIRVGeneratorMacro> macros;
 
-	for (int i = 1; i < argc; i++)
+	//! if they are specified, an output is written for each unique binary with an index of permutations
+	std::vector<LLGI::SPIRVVariantAxis> axes;
+
+	//! outputs which are specified with --output-* are generated from SPIR-V which is generated once
+	std::array<std::string, static_cast<int>(OutputType::Max)> outputPaths;
+};
+
+//! a file which an output depends on and a hash of its content
+struct Dependency
+{
+	std::string path;
+	uint64_t hash = 0;
+};
+
+std::shared_ptr<LLGI::SPIRVTranspiler> CreateTranspiler(OutputType outputType, const TranspilerOption& option)
+{
+	if (outputType == OutputType::GLSL)
 	{
-		args.emplace_back(argv[i]);
+		return std::make_shared<LLGI::SPIRVToGLSLTranspiler>(
+			false, option.shaderModel != 0 ? option.shaderModel : 430, option.isES, option.plain);
+	}
+	else if (outputType == OutputType::VULKAN_GLSL)
+	{
+		return std::make_shared<LLGI::SPIRVToGLSLTranspiler>(true);
+	}
+	else if (outputType == OutputType::MSL)
+	{
+		return std::make_shared<LLGI::SPIRVToMSLTranspiler>();
+	}
+	else if (outputType == OutputType::HLSL)
+	{
+		return std::make_shared<LLGI::SPIRVToHLSLTranspiler>(option.shaderModel != 0 ? option.shaderModel : 40, option.isDX12);
 	}
 
-	LLGI::ShaderStageType shaderStage = LLGI::ShaderStageType::Max;
+	return nullptr;
+}
+
+std::vector<uint8_t> LoadFile(std::string path)
+{
+	std::ifstream file(path, std::ios_base::binary | std::ios_base::ate);
+	if (file)
+	{
+		std::vector<uint8_t> ret;
+		auto size = (int)file.tellg();
+		ret.resize(size);
+		file.seekg(0, file.beg);
+		file.read((char*)ret.data(), size);
+		return ret;
+	}
+	return std::vector<uint8_t>();
+}
+
+//! FNV-1a of a file. The content is compared instead of a timestamp because it is portable.
+bool HashFile(const std::string& path, uint64_t& hash)
+{
+	std::ifstream file(path, std::ios_base::binary);
+	if (!file)
+	{
+		return false;
+	}
+
+	hash = 14695981039346656037ULL;
+	for (std::istreambuf_iterator<char> it(file), end; it != end; ++it)
+	{
+		hash ^= static_cast<uint8_t>(*it);
+		hash *= 1099511628211ULL;
+	}
+
+	return true;
+}
+
+/**
+	@brief	parse arguments of a shader
+	@return	false if arguments are invalid. A reason is written into the log.
+*/
+bool ParseJob(const std::vector<std::string>& args, TranspileJob& job, std::ostream& log)
+{
 	OutputType outputType = OutputType::Max;
-	std::string code;
-	std::string inputPath;
 	std::string outputPath;
-	bool isES = false;
-	bool isDX12 = false;
-	bool plain = false;
-	int shaderModel = 0;
-	std::vector<LLGI::SPIRVGeneratorMacro> macros;
+
+	const std::array<std::string, static_cast<int>(OutputType::Max)> outputOptions = {
+		"--output-glsl", "--output-vulkan-glsl", "--output-msl", "--output-hlsl"};
 
 	for (size_t i = 0; i < args.size();)
 	{
 		if (args[i] == "--vert")
 		{
-			shaderStage = LLGI::ShaderStageType::Vertex;
+			job.shaderStage = LLGI::ShaderStageType::Vertex;
 			i += 1;
 		}
 		else if (args[i] == "--frag")
 		{
-			shaderStage = LLGI::ShaderStageType::Pixel;
+			job.shaderStage = LLGI::ShaderStageType::Pixel;
 			i += 1;
 		}
 		else if (args[i] == "--comp")
 		{
-			shaderStage = LLGI::ShaderStageType::Compute;
+			job.shaderStage = LLGI::ShaderStageType::Compute;
 			i += 1;
 		}
 		else if (args[i] == "-G")
@@ -74,141 +164,961 @@ int main(int argc, char* argv[])
 		}
 		else if (args[i] == "-D")
 		{
-			macros.push_back(LLGI::SPIRVGeneratorMacro(args[i + 1].c_str(), args[i + 2].c_str()));
+			job.macros.push_back(LLGI::SPIRVGeneratorMacro(args[i + 1].c_str(), args[i + 2].c_str()));
+			i += 3;
+		}
+		else if (args[i] == "--variant")
+		{
+			// --variant NAME VALUE0,VALUE1,...
+			if (i + 2 >= args.size())
+			{
+				log << "Invalid variant" << std::endl;
+				return false;
+			}
+
+			LLGI::SPIRVVariantAxis axis;
+			axis.Name = args[i + 1];
+
+			std::istringstream values(args[i + 2]);
+			std::string value;
+			while (std::getline(values, value, ','))
+			{
+				axis.Values.push_back(value);
+			}
+
+			job.axes.push_back(axis);
 			i += 3;
 		}
 		else if (args[i] == "--sm")
 		{
-			shaderModel = atoi(args[i + 1].c_str());
+			job.option.shaderModel = atoi(args[i + 1].c_str());
 			i += 2;
 		}
 		else if (args[i] == "--es")
 		{
-			isES = true;
+			job.option.isES = true;
 			i += 1;
 		}
 		else if (args[i] == "--plain")
 		{
-			plain = true;
+			job.option.plain = true;
 			i += 1;
 		}
 		else if (args[i] == "--dx12")
 		{
-			isDX12 = true;
+			job.option.isDX12 = true;
+			i += 1;
+		}
+		else if (args[i] == "--parallel")
+		{
+			job.isParallel = true;
 			i += 1;
 		}
 		else if (args[i] == "--input")
 		{
 			if (i == args.size() - 1)
 			{
-				std::cout << "Invald input" << std::endl;
-				return 0;
+				log << "Invald input" << std::endl;
+				return false;
 			}
 
 			std::ifstream ifs(args[i + 1]);
 			if (ifs.fail())
 			{
-				std::cout << "Invald input" << std::endl;
-				return 0;
+				log << "Invald input" << std::endl;
+				return false;
 			}
-			code = std::string((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
-			inputPath = args[i + 1];
+			job.inputPath = args[i + 1];
 			i += 2;
 		}
 		else if (args[i] == "--output")
 		{
 			if (i == args.size() - 1)
 			{
-				std::cout << "Invald output" << std::endl;
-				return 0;
+				log << "Invald output" << std::endl;
+				return false;
 			}
 
 			outputPath = args[i + 1];
 
 			i += 2;
 		}
+		else if (std::find(outputOptions.begin(), outputOptions.end(), args[i]) != outputOptions.end())
+		{
+			if (i == args.size() - 1)
+			{
+				log << "Invald output" << std::endl;
+				return false;
+			}
+
+			const auto type = std::find(outputOptions.begin(), outputOptions.end(), args[i]) - outputOptions.begin();
+			job.outputPaths[type] = args[i + 1];
+
+			i += 2;
+		}
 		else
 		{
 			i++;
 		}
 	}
 
-	if (outputType == OutputType::Max)
+	// -G, -V, -M and -H with --output
+	if (outputType != OutputType::Max && outputPath != "")
 	{
-		std::cout << "Unknown type" << std::endl;
-		return 0;
+		job.outputPaths[static_cast<int>(outputType)] = outputPath;
 	}
 
-	if (shaderStage == LLGI::ShaderStageType::Max)
+	if (std::all_of(job.outputPaths.begin(), job.outputPaths.end(), [](const std::string& path) { return path == ""; }))
 	{
-		std::cout << "Unknown ShaderStage" << std::endl;
-		return 0;
+		if (outputType == OutputType::Max)
+		{
+			log << "Unknown type" << std::endl;
+			return false;
+		}
+
+		log << "Invalid output type" << std::endl;
+		return false;
 	}
 
-	if (outputPath == "")
+	if (job.shaderStage == LLGI::ShaderStageType::Max)
 	{
-		std::cout << "Invalid output type" << std::endl;
-		return 0;
+		log << "Unknown ShaderStage" << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+/**
+	@brief	transpile SPIR-V and write it
+	@param	log	messages are written into it instead of std::cout because it may be called on multiple threads
+*/
+bool TranspileAndWrite(const std::shared_ptr<LLGI::SPIRV>& spirv,
+					   OutputType outputType,
+					   const TranspilerOption& option,
+					   const std::string& inputPath,
+					   const std::string& outputPath,
+					   std::ostream& log)
+{
+	auto transpiler = CreateTranspiler(outputType, option);
+
+	log << inputPath << " -> " << outputPath << " ShaderModel=" << option.shaderModel << std::endl;
+	if (!transpiler->Transpile(spirv))
+	{
+		log << transpiler->GetErrorCode() << std::endl;
+		return false;
+	}
+
+	std::ofstream outputfile(outputPath);
+	if (outputfile.bad())
+	{
+		log << "Invald output" << std::endl;
+		return false;
+	}
+
+	outputfile << transpiler->GetCode();
+	return true;
+}
+
+//! write which binary is used by each permutation as lines "<key> <binary index>"
+bool WriteVariantIndex(const std::vector<LLGI::SPIRVVariantGenerator::Variant>& variants, const std::string& path, std::ostream& log)
+{
+	std::ofstream file(path);
+	for (const auto& variant : variants)
+	{
+		file << variant.Key << " " << variant.BinaryIndex << "\n";
+	}
+
+	if (!file)
+	{
+		log << "Invald output" << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+/**
+	@brief	generate SPIR-V of a shader and write all outputs
+	@param	includedPaths	paths of files which are included by the shader
+	@param	variantThreadCount	the number of threads which generate variants. If it is zero or less, it is decided by the number of cores.
+	@note
+	If variants are specified, "<output>.<binary index>" is written for each unique binary and "<output>.index" is written for permutations.
+*/
+bool RunJob(const std::shared_ptr<LLGI::SPIRVGenerator>& generator,
+			const TranspileJob& job,
+			std::ostream& log,
+			std::vector<std::string>& includedPaths,
+			int32_t variantThreadCount = 0)
+{
+	const auto code = LoadFile(job.inputPath);
+	const std::string codeStr(code.begin(), code.end());
+
+	// Vulkan GLSL requires SPIR-V whose Y is inverted, so SPIR-V is generated at most twice
+	std::vector<std::shared_ptr<LLGI::SPIRV>> spirvs[2];
+	std::vector<LLGI::SPIRVVariantGenerator::Variant> variants[2];
+
+	for (int i = 0; i < static_cast<int>(OutputType::Max); i++)
+	{
+		if (job.outputPaths[i] == "")
+		{
+			continue;
+		}
+
+		const int group = static_cast<OutputType>(i) == OutputType::VULKAN_GLSL ? 1 : 0;
+		if (!spirvs[group].empty())
+		{
+			continue;
+		}
+
+		if (job.axes.empty())
+		{
+			auto spirv = generator->Generate(job.inputPath.c_str(), codeStr.c_str(), job.macros, job.shaderStage, group == 1);
+
+			if (spirv->GetData().size() == 0)
+			{
+				log << spirv->GetError() << std::endl;
+				return false;
+			}
+
+			spirvs[group].push_back(spirv);
+			includedPaths = spirv->GetIncludedPaths();
+		}
+		else
+		{
+			LLGI::SPIRVVariantGenerator variantGenerator(generator);
+			if (!variantGenerator.Generate(
+					job.inputPath.c_str(), codeStr.c_str(), job.macros, job.axes, job.shaderStage, group == 1, variantThreadCount))
+			{
+				log << variantGenerator.GetError() << std::endl;
+				return false;
+			}
+
+			spirvs[group] = variantGenerator.GetBinaries();
+			variants[group] = variantGenerator.GetVariants();
+			includedPaths = variantGenerator.GetIncludedPaths();
+
+			log << job.inputPath << " Variants=" << variants[group].size() << " Binaries=" << spirvs[group].size() << std::endl;
+		}
+	}
+
+	// spirv-cross compilers are independent of each other, so targets can be transpiled in parallel
+	std::array<std::ostringstream, static_cast<int>(OutputType::Max)> logs;
+	std::array<bool, static_cast<int>(OutputType::Max)> results;
+	results.fill(true);
+	std::vector<std::thread> threads;
+
+	for (int i = 0; i < static_cast<int>(OutputType::Max); i++)
+	{
+		if (job.outputPaths[i] == "")
+		{
+			continue;
+		}
+
+		const auto type = static_cast<OutputType>(i);
+		const int group = type == OutputType::VULKAN_GLSL ? 1 : 0;
+		auto transpile = [&, i, type, group]() {
+			if (job.axes.empty())
+			{
+				results[i] = TranspileAndWrite(spirvs[group][0], type, job.option, job.inputPath, job.outputPaths[i], logs[i]);
+				return;
+			}
+
+			for (size_t b = 0; b < spirvs[group].size(); b++)
+			{
+				const auto outputPath = job.outputPaths[i] + "." + std::to_string(b);
+				results[i] = TranspileAndWrite(spirvs[group][b], type, job.option, job.inputPath, outputPath, logs[i]) && results[i];
+			}
+
+			results[i] = WriteVariantIndex(variants[group], job.outputPaths[i] + ".index", logs[i]) && results[i];
+		};
+
+		if (job.isParallel)
+		{
+			threads.emplace_back(transpile);
+		}
+		else
+		{
+			transpile();
+		}
+	}
+
+	for (auto& thread : threads)
+	{
+		thread.join();
+	}
+
+	for (const auto& targetLog : logs)
+	{
+		log << targetLog.str();
+	}
+
+	return std::all_of(results.begin(), results.end(), [](bool result) { return result; });
+}
+
+std::vector<std::string> SplitArguments(const std::string& line)
+{
+	std::vector<std::string> args;
+	std::istringstream stream(line);
+	std::string arg;
+	while (stream >> arg)
+	{
+		args.push_back(arg);
+	}
+	return args;
+}
+
+/**
+	@brief	load dependencies of outputs which are built in the previous run
+	@note
+	A line "job <arguments>" is followed by lines "dep <hash> <path>".
+*/
+std::map<std::string, std::vector<Dependency>> LoadState(const std::string& path)
+{
+	std::map<std::string, std::vector<Dependency>> state;
+	std::ifstream file(path);
+	std::string line;
+	std::vector<Dependency>* dependencies = nullptr;
+
+	while (std::getline(file, line))
+	{
+		if (line.compare(0, 4, "job ") == 0)
+		{
+			dependencies = &state[line.substr(4)];
+		}
+		else if (line.compare(0, 4, "dep ") == 0 && dependencies != nullptr)
+		{
+			const auto separator = line.find(' ', 4);
+			if (separator == std::string::npos)
+			{
+				continue;
+			}
+
+			Dependency dependency;
+			dependency.hash = std::strtoull(line.substr(4, separator - 4).c_str(), nullptr, 16);
+			dependency.path = line.substr(separator + 1);
+			dependencies->push_back(dependency);
+		}
+	}
+
+	return state;
+}
+
+bool SaveState(const std::string& path, const std::map<std::string, std::vector<Dependency>>& state)
+{
+	std::ofstream file(path);
+	if (!file)
+	{
+		return false;
+	}
+
+	for (const auto& job : state)
+	{
+		file << "job " << job.first << "\n";
+		for (const auto& dependency : job.second)
+		{
+			file << "dep " << std::hex << dependency.hash << std::dec << " " << dependency.path << "\n";
+		}
+	}
+
+	return static_cast<bool>(file);
+}
+
+//! whether outputs exist and files which they depend on are not changed since they are built
+bool IsUpToDate(const TranspileJob& job, const std::vector<Dependency>& dependencies)
+{
+	for (const auto& outputPath : job.outputPaths)
+	{
+		if (outputPath == "")
+		{
+			continue;
+		}
+
+		if (job.axes.empty())
+		{
+			if (!std::ifstream(outputPath))
+			{
+				return false;
+			}
+			continue;
+		}
+
+		// all binaries which are listed in the index of variants
+		std::ifstream index(outputPath + ".index");
+		if (!index)
+		{
+			return false;
+		}
+
+		std::string key;
+		int32_t binaryIndex = 0;
+		while (index >> key >> binaryIndex)
+		{
+			if (!std::ifstream(outputPath + "." + std::to_string(binaryIndex)))
+			{
+				return false;
+			}
+		}
+	}
+
+	for (const auto& dependency : dependencies)
+	{
+		uint64_t hash = 0;
+		if (!HashFile(dependency.path, hash) || hash != dependency.hash)
+		{
+			return false;
+		}
+	}
+
+	return !dependencies.empty();
+}
+
+/**
+	@brief	transpile shaders in a manifest on multiple threads
+	@note
+	Each line of a manifest contains arguments of a shader. Empty lines and lines which start with # are ignored.
+	Arguments are separated by spaces, so paths must not contain spaces.
+	Shaders whose inputs and included files are not changed since the previous run are skipped.
+*/
+int RunManifest(const std::string& manifestPath, std::string statePath, int32_t threadCount)
+{
+	std::ifstream manifest(manifestPath);
+	if (!manifest)
+	{
+		std::cout << "Invald manifest" << std::endl;
+		return 1;
+	}
+
+	if (statePath == "")
+	{
+		statePath = manifestPath + ".state";
+	}
+
+	std::vector<std::string> lines;
+	std::string line;
+	while (std::getline(manifest, line))
+	{
+		if (!line.empty() && line.back() == '\r')
+		{
+			line.pop_back();
+		}
+
+		const auto args = SplitArguments(line);
+		if (args.empty() || args[0][0] == '#')
+		{
+			continue;
+		}
+
+		lines.push_back(line);
+	}
+
+	const auto previousState = LoadState(statePath);
+
+	// glslang is initialized once for all shaders
+	auto generator = std::make_shared<LLGI::SPIRVGenerator>(LoadFile);
+
+	std::vector<std::ostringstream> logs(lines.size());
+	std::vector<bool> results(lines.size(), true);
+	std::vector<bool> isSkipped(lines.size(), false);
+	std::vector<std::vector<Dependency>> dependencies(lines.size());
+
+	std::mutex mutex;
+	std::condition_variable condition;
+	size_t finishedCount = 0;
+
+	{
+		LLGI::WorkerPool workerPool(threadCount);
+
+		for (size_t i = 0; i < lines.size(); i++)
+		{
+			workerPool.Enqueue([&, i]() {
+				TranspileJob job;
+				bool result = true;
+				bool skipped = false;
+
+				if (!ParseJob(SplitArguments(lines[i]), job, logs[i]))
+				{
+					logs[i] << lines[i] << std::endl;
+					result = false;
+				}
+				else
+				{
+					auto previous = previousState.find(lines[i]);
+					if (previous != previousState.end() && IsUpToDate(job, previous->second))
+					{
+						dependencies[i] = previous->second;
+						skipped = true;
+					}
+					else
+					{
+						// jobs already run on all cores, so targets and variants are not processed in parallel in a job
+						job.isParallel = false;
+
+						std::vector<std::string> includedPaths;
+						result = RunJob(generator, job, logs[i], includedPaths, 1);
+
+						includedPaths.insert(includedPaths.begin(), job.inputPath);
+						for (const auto& path : includedPaths)
+						{
+							Dependency dependency;
+							dependency.path = path;
+							if (HashFile(path, dependency.hash))
+							{
+								dependencies[i].push_back(dependency);
+							}
+						}
+					}
+				}
+
+				// std::vector<bool> is not safe to write from multiple threads
+				std::lock_guard<std::mutex> lock(mutex);
+				results[i] = result;
+				isSkipped[i] = skipped;
+				finishedCount++;
+				condition.notify_one();
+			});
+		}
+
+		std::unique_lock<std::mutex> lock(mutex);
+		condition.wait(lock, [&]() { return finishedCount == lines.size(); });
+	}
+
+	// failed shaders are not recorded to build them again
+	std::map<std::string, std::vector<Dependency>> state;
+	int32_t builtCount = 0;
+	int32_t skippedCount = 0;
+	int32_t failedCount = 0;
+
+	for (size_t i = 0; i < lines.size(); i++)
+	{
+		std::cout << logs[i].str();
+
+		if (!results[i])
+		{
+			failedCount++;
+			continue;
+		}
+
+		if (isSkipped[i])
+		{
+			skippedCount++;
+		}
+		else
+		{
+			builtCount++;
+		}
+
+		state[lines[i]] = dependencies[i];
+	}
+
+	if (!SaveState(statePath, state))
+	{
+		std::cout << "Failed to save " << statePath << std::endl;
 	}
 
-	auto loadFunc = [](std::string s) -> std::vector<uint8_t> {
-		std::ifstream file(s, std::ios_base::binary | std::ios_base::ate);
-		if (file)
+	std::cout << "Built=" << builtCount << " Skipped=" << skippedCount << " Failed=" << failedCount << std::endl;
+
+	return failedCount == 0 ? 0 : 1;
+}
+
+//! a file which is packed into a bundle
+struct BundleSource
+{
+	std::string target;
+	std::string name;
+	std::string variant;
+	std::string path;
+	LLGI::ShaderStageType shaderStage = LLGI::ShaderStageType::Max;
+};
+
+//! a shader stage from an extension of a name such as "simple_rectangle.vert"
+bool GetShaderStage(const std::string& name, LLGI::ShaderStageType& shaderStage)
+{
+	const std::array<std::string, 3> extensions = {".vert", ".frag", ".comp"};
+	const std::array<LLGI::ShaderStageType, 3> shaderStages = {
+		LLGI::ShaderStageType::Vertex, LLGI::ShaderStageType::Pixel, LLGI::ShaderStageType::Compute};
+
+	for (size_t i = 0; i < extensions.size(); i++)
+	{
+		if (name.size() >= extensions[i].size() && name.compare(name.size() - extensions[i].size(), extensions[i].size(), extensions[i]) == 0)
 		{
-			std::vector<uint8_t> ret;
-			auto size = (int)file.tellg();
-			ret.resize(size);
-			file.seekg(0, file.beg);
-			file.read((char*)ret.data(), size);
-			return ret;
+			shaderStage = shaderStages[i];
+			return true;
 		}
-		return std::vector<uint8_t>();
+	}
+
+	return false;
+}
+
+/**
+	@brief	load a list of files which are packed into a bundle
+	@note
+	Each line is "<target> <path>". A name of a shader is a file name without ".spv".
+	If a path is "<output>.index" which is written with --variant, all binaries of the output are packed with keys of variants.
+*/
+bool LoadBundleList(const std::string& listPath, std::vector<BundleSource>& sources)
+{
+	std::ifstream list(listPath);
+	if (!list)
+	{
+		std::cout << "Invald list" << std::endl;
+		return false;
+	}
+
+	std::string line;
+	while (std::getline(list, line))
+	{
+		auto args = SplitArguments(line);
+		if (args.empty() || args[0][0] == '#')
+		{
+			continue;
+		}
+
+		if (args.size() != 2)
+		{
+			std::cout << "Invalid line : " << line << std::endl;
+			return false;
+		}
+
+		BundleSource source;
+		source.target = args[0];
+		source.path = args[1];
+
+		const auto separator = source.path.find_last_of("/\\");
+		source.name = separator == std::string::npos ? source.path : source.path.substr(separator + 1);
+
+		const std::string spirvExtension = ".spv";
+		const std::string indexExtension = ".index";
+
+		bool isIndex = false;
+		if (source.name.size() > indexExtension.size() &&
+			source.name.compare(source.name.size() - indexExtension.size(), indexExtension.size(), indexExtension) == 0)
+		{
+			source.name.resize(source.name.size() - indexExtension.size());
+			isIndex = true;
+		}
+		else if (source.name.size() > spirvExtension.size() &&
+				 source.name.compare(source.name.size() - spirvExtension.size(), spirvExtension.size(), spirvExtension) == 0)
+		{
+			source.name.resize(source.name.size() - spirvExtension.size());
+		}
+
+		if (!GetShaderStage(source.name, source.shaderStage))
+		{
+			std::cout << "Unknown ShaderStage : " << source.path << std::endl;
+			return false;
+		}
+
+		if (!isIndex)
+		{
+			sources.push_back(source);
+			continue;
+		}
+
+		std::ifstream index(source.path);
+		if (!index)
+		{
+			std::cout << "Invald input : " << source.path << std::endl;
+			return false;
+		}
+
+		const auto outputPath = source.path.substr(0, source.path.size() - indexExtension.size());
+
+		std::string key;
+		int32_t binaryIndex = 0;
+		while (index >> key >> binaryIndex)
+		{
+			auto variantSource = source;
+			variantSource.variant = key;
+			variantSource.path = outputPath + "." + std::to_string(binaryIndex);
+			sources.push_back(variantSource);
+		}
+	}
+
+	return true;
+}
+
+/**
+	@brief	pack files in a list into a bundle which is loaded with LLGI::ShaderBundle
+	@note
+	Files which are shared by variants are stored once.
+	Reflection is stored if a list contains SPIR-V of a shader.
+*/
+int PackBundle(const std::string& outputPath, const std::string& listPath)
+{
+	std::vector<BundleSource> sources;
+	if (!LoadBundleList(listPath, sources))
+	{
+		return 1;
+	}
+
+	// sorted in the same order as strcmp to find entries with a binary search
+	std::sort(sources.begin(), sources.end(), [](const BundleSource& a, const BundleSource& b) {
+		return std::tie(a.target, a.name, a.variant) < std::tie(b.target, b.name, b.variant);
+	});
+
+	for (size_t i = 1; i < sources.size(); i++)
+	{
+		if (std::tie(sources[i - 1].target, sources[i - 1].name, sources[i - 1].variant) ==
+			std::tie(sources[i].target, sources[i].name, sources[i].variant))
+		{
+			std::cout << "Duplicated shader : " << sources[i].target << " " << sources[i].name << " " << sources[i].variant << std::endl;
+			return 1;
+		}
+	}
+
+	std::vector<LLGI::ShaderBundleEntry> entries(sources.size());
+
+	// strings follow entries
+	std::vector<uint8_t> strings;
+	std::map<std::string, uint32_t> stringOffsets;
+	const auto stringsOffset = static_cast<uint32_t>(sizeof(LLGI::ShaderBundleHeader) + sizeof(LLGI::ShaderBundleEntry) * entries.size());
+
+	auto addString = [&](const std::string& str) -> uint32_t {
+		auto it = stringOffsets.find(str);
+		if (it != stringOffsets.end())
+		{
+			return it->second;
+		}
+
+		const auto offset = stringsOffset + static_cast<uint32_t>(strings.size());
+		strings.insert(strings.end(), str.begin(), str.end());
+		strings.push_back(0);
+		stringOffsets[str] = offset;
+		return offset;
 	};
 
-	auto generator = std::make_shared<LLGI::SPIRVGenerator>(loadFunc);
+	// data follows strings
+	std::vector<uint8_t> data;
+	std::map<std::string, size_t> dataIndexes;
+	std::vector<std::vector<uint8_t>> files;
 
-	auto spirv = generator->Generate(inputPath.c_str(), code.c_str(), macros, shaderStage, outputType == OutputType::VULKAN_GLSL);
+	// reflection is read from SPIR-V and shared by all targets with the same name and variant
+	std::map<std::tuple<std::string, std::string>, size_t> reflectionIndexes;
+	for (const auto& source : sources)
+	{
+		if (source.target != "SPIRV")
+		{
+			continue;
+		}
 
-	if (spirv->GetData().size() == 0)
+		const auto file = LoadFile(source.path);
+		if (file.empty() || file.size() % sizeof(uint32_t) != 0)
+		{
+			std::cout << "Invald input : " << source.path << std::endl;
+			return 1;
+		}
+
+		std::vector<uint32_t> code(file.size() / sizeof(uint32_t));
+		memcpy(code.data(), file.data(), file.size());
+
+		LLGI::SPIRVReflection reflection;
+		if (!reflection.Transpile(std::make_shared<LLGI::SPIRV>(code, source.shaderStage)))
+		{
+			std::cout << "Failed to reflect : " << source.path << std::endl;
+			return 1;
+		}
+
+		LLGI::ShaderBundleReflection header;
+		memset(&header, 0, sizeof(header));
+		header.UniformCount = static_cast<uint32_t>(reflection.Uniforms.size());
+		header.TextureCount = static_cast<uint32_t>(reflection.Textures.size());
+		header.NumThreads[0] = reflection.NumThreads.X;
+		header.NumThreads[1] = reflection.NumThreads.Y;
+		header.NumThreads[2] = reflection.NumThreads.Z;
+
+		std::vector<LLGI::ShaderBundleUniform> uniforms;
+		for (const auto& u : reflection.Uniforms)
+		{
+			uniforms.push_back(LLGI::ShaderBundleUniform{addString(u.Name), u.Offset, u.Size});
+		}
+
+		std::vector<LLGI::ShaderBundleTexture> textures;
+		for (const auto& t : reflection.Textures)
+		{
+			textures.push_back(LLGI::ShaderBundleTexture{addString(t.Name), t.Offset});
+		}
+
+		std::vector<uint8_t> block(sizeof(header) + sizeof(LLGI::ShaderBundleUniform) * uniforms.size() +
+								   sizeof(LLGI::ShaderBundleTexture) * textures.size());
+		auto dst = block.data();
+		memcpy(dst, &header, sizeof(header));
+		dst += sizeof(header);
+
+		if (!uniforms.empty())
+		{
+			memcpy(dst, uniforms.data(), sizeof(LLGI::ShaderBundleUniform) * uniforms.size());
+			dst += sizeof(LLGI::ShaderBundleUniform) * uniforms.size();
+		}
+
+		if (!textures.empty())
+		{
+			memcpy(dst, textures.data(), sizeof(LLGI::ShaderBundleTexture) * textures.size());
+		}
+
+		reflectionIndexes[std::make_tuple(source.name, source.variant)] = files.size();
+		files.emplace_back(std::move(block));
+	}
+
+	for (size_t i = 0; i < sources.size(); i++)
 	{
-		std::cout << spirv->GetError() << std::endl;
-		return 0;
+		const auto& source = sources[i];
+		auto& entry = entries[i];
+		memset(&entry, 0, sizeof(entry));
+
+		entry.TargetOffset = addString(source.target);
+		entry.NameOffset = addString(source.name);
+		entry.VariantOffset = addString(source.variant);
+		entry.ShaderStage = static_cast<uint32_t>(source.shaderStage);
+
+		auto it = dataIndexes.find(source.path);
+		if (it == dataIndexes.end())
+		{
+			auto file = LoadFile(source.path);
+			if (file.empty())
+			{
+				std::cout << "Invald input : " << source.path << std::endl;
+				return 1;
+			}
+
+			it = dataIndexes.insert(std::make_pair(source.path, files.size())).first;
+			files.emplace_back(std::move(file));
+		}
+
+		// an offset is decided after the size of strings is decided
+		entry.DataOffset = static_cast<uint32_t>(it->second);
+		entry.DataSize = static_cast<uint32_t>(files[it->second].size());
+
+		// an index is added by one because zero means no reflection
+		auto reflectionIt = reflectionIndexes.find(std::make_tuple(source.name, source.variant));
+		if (reflectionIt != reflectionIndexes.end())
+		{
+			entry.ReflectionOffset = static_cast<uint32_t>(reflectionIt->second + 1);
+		}
 	}
 
-	auto transpiler = std::shared_ptr<LLGI::SPIRVTranspiler>();
+	auto alignOffset = [](size_t offset) {
+		return (offset + LLGI::ShaderBundleAlignment - 1) / LLGI::ShaderBundleAlignment * LLGI::ShaderBundleAlignment;
+	};
 
-	if (outputType == OutputType::GLSL)
+	std::vector<uint32_t> fileOffsets;
+	auto offset = alignOffset(stringsOffset + strings.size());
+	for (const auto& file : files)
 	{
-		transpiler = std::make_shared<LLGI::SPIRVToGLSLTranspiler>(false, shaderModel != 0 ? shaderModel : 430, isES, plain);
+		fileOffsets.push_back(static_cast<uint32_t>(offset));
+
+		// terminated with zero to be used as a string
+		offset = alignOffset(offset + file.size() + 1);
 	}
-	else if (outputType == OutputType::VULKAN_GLSL)
+
+	for (auto& entry : entries)
 	{
-		transpiler = std::make_shared<LLGI::SPIRVToGLSLTranspiler>(true);
+		entry.DataOffset = fileOffsets[entry.DataOffset];
+
+		if (entry.ReflectionOffset != 0)
+		{
+			entry.ReflectionOffset = fileOffsets[entry.ReflectionOffset - 1];
+		}
 	}
-	else if (outputType == OutputType::MSL)
+
+	LLGI::ShaderBundleHeader header;
+	memcpy(header.Magic, LLGI::ShaderBundleMagic, sizeof(header.Magic));
+	header.Version = LLGI::ShaderBundleVersion;
+	header.EntryCount = static_cast<uint32_t>(entries.size());
+	header.Reserved = 0;
+
+	std::vector<uint8_t> bundle(offset, 0);
+	memcpy(bundle.data(), &header, sizeof(header));
+
+	if (!entries.empty())
 	{
-		transpiler = std::make_shared<LLGI::SPIRVToMSLTranspiler>();
+		memcpy(bundle.data() + sizeof(header), entries.data(), sizeof(LLGI::ShaderBundleEntry) * entries.size());
 	}
-	else if (outputType == OutputType::HLSL)
+
+	if (!strings.empty())
 	{
-		transpiler = std::make_shared<LLGI::SPIRVToHLSLTranspiler>(shaderModel != 0 ? shaderModel : 40, isDX12);
+		memcpy(bundle.data() + stringsOffset, strings.data(), strings.size());
 	}
 
-	std::cout << inputPath << " -> " << outputPath << " ShaderModel=" << shaderModel << std::endl;
-	if (!transpiler->Transpile(spirv))
+	for (size_t i = 0; i < files.size(); i++)
 	{
-		std::cout << transpiler->GetErrorCode() << std::endl;
-		return 0;
+		memcpy(bundle.data() + fileOffsets[i], files[i].data(), files[i].size());
 	}
 
-	std::ofstream outputfile(outputPath);
-	if (outputfile.bad())
+	std::ofstream file(outputPath, std::ios::binary);
+	file.write(reinterpret_cast<const char*>(bundle.data()), bundle.size());
+	if (!file)
 	{
 		std::cout << "Invald output" << std::endl;
+		return 1;
+	}
+
+	std::cout << outputPath << " Entries=" << entries.size() << " Files=" << files.size() << " Size=" << bundle.size() << std::endl;
+
+	return 0;
+}
+
+int main(int argc, char* argv[])
+{
+
+	std::vector<std::string> args;
+
+	for (int i = 1; i < argc; i++)
+	{
+		args.emplace_back(argv[i]);
+	}
+
+	// --bundle <output> <list>
+	auto bundleArg = std::find(args.begin(), args.end(), "--bundle");
+	if (bundleArg != args.end())
+	{
+		if (args.end() - bundleArg < 3)
+		{
+			std::cout << "Invald bundle" << std::endl;
+			return 1;
+		}
+
+		return PackBundle(*(bundleArg + 1), *(bundleArg + 2));
+	}
+
+	// --manifest <path> [--state <path>] [--jobs <count>]
+	auto manifestArg = std::find(args.begin(), args.end(), "--manifest");
+	if (manifestArg != args.end())
+	{
+		if (manifestArg + 1 == args.end())
+		{
+			std::cout << "Invald manifest" << std::endl;
+			return 1;
+		}
+
+		std::string statePath;
+		int32_t threadCount = 0;
+
+		auto stateArg = std::find(args.begin(), args.end(), "--state");
+		if (stateArg != args.end() && stateArg + 1 != args.end())
+		{
+			statePath = *(stateArg + 1);
+		}
+
+		auto jobsArg = std::find(args.begin(), args.end(), "--jobs");
+		if (jobsArg != args.end() && jobsArg + 1 != args.end())
+		{
+			threadCount = atoi((jobsArg + 1)->c_str());
+		}
+
+		return RunManifest(*(manifestArg + 1), statePath, threadCount);
+	}
+
+	TranspileJob job;
+	if (!ParseJob(args, job, std::cout))
+	{
 		return 0;
 	}
 
-	outputfile << transpiler->GetCode();
+	auto generator = std::make_shared<LLGI::SPIRVGenerator>(LoadFile);
+
+	std::vector<std::string> includedPaths;
+	RunJob(generator, job, std::cout, includedPaths);
 
 	return 0;
 }
@@ -1,4 +1,5 @@
 #include "ShaderTranspilerCore.h"
+#include "../../src/Utils/LLGI.WorkerPool.h"
 
 #if defined(ENABLE_GLSLANG_WITHOUT_INSTALL)
 #include <SPIRV/GlslangToSpv.h>
@@ -9,7 +10,10 @@
 #include <glslang/Public/ResourceLimits.h>
 #include <glslang/Public/ShaderLang.h>
 
+#include <algorithm>
+#include <condition_variable>
 #include <functional>
+#include <unordered_map>
 
 #if (ENABLE_SPIRVCROSS_WITHOUT_INSTALL)
 #include <spirv_cross.hpp>
@@ -97,9 +101,13 @@ public:
 
 	virtual ~DirStackFileIncluder() override {}
 
+	//! paths of files which are included
+	const std::vector<std::string>& getIncludedPaths() const { return includedPaths; }
+
 protected:
 	typedef char tUserDataElement;
 	std::vector<std::string> directoryStack;
+	std::vector<std::string> includedPaths;
 	int externalLocalDirectoryCount;
 	std::function<std::vector<std::uint8_t>(std::string)> onLoad_;
 
@@ -125,6 +133,11 @@ protected:
 			{
 				directoryStack.push_back(getDirectory(path));
 
+				if (std::find(includedPaths.begin(), includedPaths.end(), path) == includedPaths.end())
+				{
+					includedPaths.push_back(path);
+				}
+
 				char* content = new tUserDataElement[file.size()];
 				memcpy(content, file.data(), file.size());
 				return new IncludeResult(path, content, file.size(), content);
@@ -505,7 +518,133 @@ std::shared_ptr<SPIRV> SPIRVGenerator::Generate(
 
 	glslang::GlslangToSpv(*program.getIntermediate(shaderStage), spirv, &spvOptions);
 
-	return std::make_shared<SPIRV>(spirv, shaderStageType);
+	auto result = std::make_shared<SPIRV>(spirv, shaderStageType);
+	result->SetIncludedPaths(includer.getIncludedPaths());
+	return result;
+}
+
+SPIRVVariantGenerator::SPIRVVariantGenerator(const std::shared_ptr<SPIRVGenerator>& generator) : generator_(generator) {}
+
+bool SPIRVVariantGenerator::Generate(const char* path,
+									 const char* code,
+									 const std::vector<SPIRVGeneratorMacro>& macros,
+									 const std::vector<SPIRVVariantAxis>& axes,
+									 ShaderStageType shaderStageType,
+									 bool isYInverted,
+									 int32_t threadCount)
+{
+	variants_.clear();
+	binaries_.clear();
+	includedPaths_.clear();
+	error_.clear();
+
+	size_t variantCount = 1;
+	for (const auto& axis : axes)
+	{
+		if (axis.Values.empty())
+		{
+			error_ = "Variant " + axis.Name + " has no value.";
+			return false;
+		}
+		variantCount *= axis.Values.size();
+	}
+
+	variants_.resize(variantCount);
+
+	for (size_t i = 0; i < variantCount; i++)
+	{
+		auto& variant = variants_[i];
+		variant.Macros = macros;
+
+		// the last axis changes first
+		auto rest = i;
+		std::vector<size_t> valueIndexes(axes.size());
+		for (size_t a = axes.size(); a > 0; a--)
+		{
+			valueIndexes[a - 1] = rest % axes[a - 1].Values.size();
+			rest /= axes[a - 1].Values.size();
+		}
+
+		for (size_t a = 0; a < axes.size(); a++)
+		{
+			const auto& value = axes[a].Values[valueIndexes[a]];
+			variant.Key += (a == 0 ? "" : ",") + axes[a].Name + "=" + value;
+			variant.Macros.push_back(SPIRVGeneratorMacro(axes[a].Name.c_str(), value.c_str()));
+		}
+	}
+
+	std::vector<std::shared_ptr<SPIRV>> spirvs(variantCount);
+
+	{
+		std::mutex mutex;
+		std::condition_variable condition;
+		size_t finishedCount = 0;
+
+		WorkerPool workerPool(threadCount);
+
+		for (size_t i = 0; i < variantCount; i++)
+		{
+			workerPool.Enqueue([&, i]() {
+				auto spirv = generator_->Generate(path, code, variants_[i].Macros, shaderStageType, isYInverted);
+
+				std::lock_guard<std::mutex> lock(mutex);
+				spirvs[i] = spirv;
+				finishedCount++;
+				condition.notify_one();
+			});
+		}
+
+		std::unique_lock<std::mutex> lock(mutex);
+		condition.wait(lock, [&]() { return finishedCount == variantCount; });
+	}
+
+	// binaries are deduplicated in order to make indexes deterministic
+	std::unordered_map<uint64_t, std::vector<int32_t>> binaryIndexes;
+
+	for (size_t i = 0; i < variantCount; i++)
+	{
+		const auto& spirv = spirvs[i];
+		if (spirv->GetData().size() == 0)
+		{
+			error_ = variants_[i].Key + " : " + spirv->GetError();
+			return false;
+		}
+
+		for (const auto& includedPath : spirv->GetIncludedPaths())
+		{
+			if (std::find(includedPaths_.begin(), includedPaths_.end(), includedPath) == includedPaths_.end())
+			{
+				includedPaths_.push_back(includedPath);
+			}
+		}
+
+		// FNV-1a
+		uint64_t hash = 14695981039346656037ULL;
+		for (auto word : spirv->GetData())
+		{
+			hash ^= word;
+			hash *= 1099511628211ULL;
+		}
+
+		auto& candidates = binaryIndexes[hash];
+		for (auto candidate : candidates)
+		{
+			if (binaries_[candidate]->GetData() == spirv->GetData())
+			{
+				variants_[i].BinaryIndex = candidate;
+				break;
+			}
+		}
+
+		if (variants_[i].BinaryIndex < 0)
+		{
+			variants_[i].BinaryIndex = static_cast<int32_t>(binaries_.size());
+			candidates.push_back(variants_[i].BinaryIndex);
+			binaries_.push_back(spirv);
+		}
+	}
+
+	return true;
 }
 
 } // namespace LLGI
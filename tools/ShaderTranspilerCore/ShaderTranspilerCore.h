@@ -30,6 +30,7 @@ private:
 	std::vector<uint32_t> data_;
 	std::string error_;
 	ShaderStageType shaderStage_;
+	std::vector<std::string> includedPaths_;
 
 public:
 	SPIRV(const std::vector<uint32_t>& data, ShaderStageType shaderStage);
@@ -41,6 +42,13 @@ public:
 	const std::vector<uint32_t>& GetData() const;
 
 	std::string GetError() const { return error_; }
+
+	/**
+		@brief	get paths of files which are included while SPIR-V is generated
+	*/
+	const std::vector<std::string>& GetIncludedPaths() const { return includedPaths_; }
+
+	void SetIncludedPaths(const std::vector<std::string>& includedPaths) { includedPaths_ = includedPaths; }
 };
 
 class SPIRVTranspiler
@@ -118,6 +126,10 @@ public:
 	SPIRVGeneratorMacro(const char* name, const char* content) : Name(name), Content(content) {}
 };
 
+/**
+	@note
+	Generate can be called from multiple threads concurrently if onLoad is thread-safe.
+*/
 class SPIRVGenerator
 {
 private:
@@ -132,4 +144,65 @@ public:
 		const char* path, const char* code, std::vector<SPIRVGeneratorMacro> macros, ShaderStageType shaderStageType, bool isYInverted);
 };
 
+/**
+	@brief	a macro and values which it takes in permutations
+*/
+class SPIRVVariantAxis
+{
+public:
+	std::string Name;
+	std::vector<std::string> Values;
+};
+
+/**
+	@brief	generate SPIR-V of all permutations of macros and deduplicate identical binaries
+*/
+class SPIRVVariantGenerator
+{
+public:
+	struct Variant
+	{
+		//! "NAME=VALUE" of each axis joined with ","
+		std::string Key;
+		std::vector<SPIRVGeneratorMacro> Macros;
+
+		//! an index of GetBinaries
+		int32_t BinaryIndex = -1;
+	};
+
+private:
+	std::shared_ptr<SPIRVGenerator> generator_;
+	std::vector<Variant> variants_;
+	std::vector<std::shared_ptr<SPIRV>> binaries_;
+	std::vector<std::string> includedPaths_;
+	std::string error_;
+
+public:
+	SPIRVVariantGenerator(const std::shared_ptr<SPIRVGenerator>& generator);
+
+	/**
+		@param	macros	macros which are common in all permutations
+		@param	threadCount	the number of threads. If it is zero or less, it is decided by the number of cores.
+		@return	false if any permutation fails
+	*/
+	bool Generate(const char* path,
+				  const char* code,
+				  const std::vector<SPIRVGeneratorMacro>& macros,
+				  const std::vector<SPIRVVariantAxis>& axes,
+				  ShaderStageType shaderStageType,
+				  bool isYInverted,
+				  int32_t threadCount = 0);
+
+	//! permutations in the order which the last axis changes first
+	const std::vector<Variant>& GetVariants() const { return variants_; }
+
+	//! unique binaries in the order which they appear in permutations
+	const std::vector<std::shared_ptr<SPIRV>>& GetBinaries() const { return binaries_; }
+
+	//! paths of files which are included by any permutation
+	const std::vector<std::string>& GetIncludedPaths() const { return includedPaths_; }
+
+	std::string GetError() const { return error_; }
+};
+
 } // namespace LLGI